@@ -0,0 +1,264 @@
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <sys/wait.h>
+
+// Сквозные замеры lab8: для каждого N генератор пишет систему с известным решением,
+// затем по очереди запускаются однопоточный, pthread- и MPI-решатели и движки общей
+// библиотеки lab8_Solver (solver_main --engine=...).
+// Каждый решатель печатает строку TIMINGS (загрузка, разложение, подстановки, запись),
+// погрешность считается по X.txt и Xtrue.txt. Итог пишется в <out>.csv и <out>.json.
+
+struct Run {
+    std::string solver;
+    int n = 0;
+    int threads = 1;
+    int procs = 1;
+    std::string engine;
+    double loadMs = 0, factorMs = 0, solveMs = 0, writeMs = 0;
+    double maxErr = 0, relErr = 0;
+    std::string status = "ok";
+};
+
+struct Config {
+    std::string data = "bench_data";
+    std::string out = "bench_results";
+    std::string kind = "dd";
+    std::string gen = "../lab8_Generator_с++/gen_main";
+    std::string single = "../lab8_singleThread_с++/single_main";
+    std::string pthread = "../lab8_MultiThread_с++/linux_main";
+    std::string mpi = "../lab8_MPI_с++/main";
+    std::string mpirun = "mpirun";
+    std::string lib = "../lab8_Solver_с++/solver_main";
+    std::vector<std::string> engines = { "serial", "threads", "tiled" };   // mpi — только при сборке через mpicxx
+    std::string pthreadArgs;   // например --dense, чтобы всегда мерить LU
+    std::vector<int> sizes = { 500, 1000, 2000 };
+    std::vector<int> threads = { 1, 2, 4 };
+    std::vector<int> procs = { 1, 2, 4 };
+    std::vector<int> mpiThreads = { 1 };   // потоков на ранг (гибридный режим)
+};
+
+std::vector<int> ParseIntList(const std::string& s)
+{
+    std::vector<int> res;
+    std::istringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty()) res.push_back(std::stoi(item));
+    return res;
+}
+
+std::vector<std::string> ParseList(const std::string& s)
+{
+    std::vector<std::string> res;
+    std::istringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty()) res.push_back(item);
+    return res;
+}
+
+// Запуск команды; stdout возвращается целиком, код завершения — в status
+std::string Execute(const std::string& cmd, int& status)
+{
+    std::string out;
+    FILE* p = popen((cmd + " 2>&1").c_str(), "r");
+    if (!p) {
+        status = -1;
+        return out;
+    }
+    char buf[4096];
+    size_t len;
+    while ((len = fread(buf, 1, sizeof(buf), p)) > 0) out.append(buf, len);
+    int rc = pclose(p);
+    status = WIFEXITED(rc) ? WEXITSTATUS(rc) : -1;
+    return out;
+}
+
+// Разбор "TIMINGS key=value ..."; false, если строки нет
+bool ParseTimings(const std::string& out, Run& r)
+{
+    size_t pos = out.rfind("TIMINGS ");
+    if (pos == std::string::npos) return false;
+    std::istringstream ss(out.substr(pos + 8, out.find('\n', pos) - pos - 8));
+    std::string kv;
+    while (ss >> kv) {
+        size_t eq = kv.find('=');
+        if (eq == std::string::npos) continue;
+        std::string key = kv.substr(0, eq), val = kv.substr(eq + 1);
+        if (key == "engine") r.engine = val;
+        else if (key == "load_ms") r.loadMs = std::stod(val);
+        else if (key == "factor_ms") r.factorMs = std::stod(val);
+        else if (key == "solve_ms") r.solveMs = std::stod(val);
+        else if (key == "write_ms") r.writeMs = std::stod(val);
+    }
+    return true;
+}
+
+std::vector<double> ReadColumn(const std::string& path)
+{
+    std::ifstream f(path);
+    std::vector<double> v;
+    double x;
+    while (f >> x) v.push_back(x);
+    return v;
+}
+
+void MeasureError(const std::string& folder, Run& r)
+{
+    std::vector<double> X = ReadColumn(folder + "/X.txt");
+    std::vector<double> Xt = ReadColumn(folder + "/Xtrue.txt");
+    if (X.size() != Xt.size() || X.empty()) {
+        r.status = "bad_output";
+        return;
+    }
+    double maxRef = 0.0;
+    for (size_t i = 0; i < X.size(); ++i) {
+        double d = std::abs(X[i] - Xt[i]);
+        r.maxErr = std::isfinite(d) ? std::max(r.maxErr, d) : HUGE_VAL;
+        maxRef = std::max(maxRef, std::abs(Xt[i]));
+    }
+    r.relErr = maxRef > 0 ? r.maxErr / maxRef : r.maxErr;
+}
+
+Run RunSolver(const std::string& solver, const std::string& cmd, const std::string& folder, int n, int threads, int procs)
+{
+    Run r;
+    r.solver = solver;
+    r.n = n;
+    r.threads = threads;
+    r.procs = procs;
+    std::remove((folder + "/X.txt").c_str());
+
+    int status = 0;
+    std::string out = Execute(cmd, status);
+    if (status != 0) r.status = "exit_" + std::to_string(status);
+    else if (!ParseTimings(out, r)) r.status = "no_timings";
+    else MeasureError(folder, r);
+
+    std::cout << std::fixed << std::setprecision(1)
+              << std::setw(8) << solver << std::setw(8) << n << std::setw(4) << threads << std::setw(4) << procs
+              << std::setw(10) << r.engine << "  load " << r.loadMs << "  factor " << r.factorMs
+              << "  solve " << r.solveMs << "  write " << r.writeMs
+              << std::scientific << std::setprecision(2) << "  err " << r.relErr << "  " << r.status << "\n";
+    return r;
+}
+
+// бесконечная погрешность в JSON числом не записывается
+std::string JsonNumber(double v)
+{
+    if (!std::isfinite(v)) return "null";
+    std::ostringstream ss;
+    ss << std::setprecision(10) << v;
+    return ss.str();
+}
+
+void WriteResults(const std::string& base, const std::vector<Run>& runs)
+{
+    std::ofstream csv(base + ".csv");
+    csv << "solver,n,threads,procs,engine,load_ms,factor_ms,solve_ms,write_ms,total_ms,max_err,rel_err,status\n";
+    csv << std::setprecision(10);
+    for (const Run& r : runs)
+        csv << r.solver << "," << r.n << "," << r.threads << "," << r.procs << "," << r.engine << ","
+            << r.loadMs << "," << r.factorMs << "," << r.solveMs << "," << r.writeMs << ","
+            << r.loadMs + r.factorMs + r.solveMs + r.writeMs << "," << r.maxErr << "," << r.relErr << "," << r.status << "\n";
+
+    std::ofstream json(base + ".json");
+    json << std::setprecision(10) << "[\n";
+    for (size_t i = 0; i < runs.size(); ++i) {
+        const Run& r = runs[i];
+        json << "  {\"solver\": \"" << r.solver << "\", \"n\": " << r.n << ", \"threads\": " << r.threads
+             << ", \"procs\": " << r.procs << ", \"engine\": \"" << r.engine << "\", \"load_ms\": " << r.loadMs
+             << ", \"factor_ms\": " << r.factorMs << ", \"solve_ms\": " << r.solveMs << ", \"write_ms\": " << r.writeMs
+             << ", \"max_err\": " << JsonNumber(r.maxErr) << ", \"rel_err\": " << JsonNumber(r.relErr)
+             << ", \"status\": \"" << r.status << "\"}" << (i + 1 < runs.size() ? "," : "") << "\n";
+    }
+    json << "]\n";
+}
+
+int main(int argc, char* argv[])
+{
+    Config c;
+    try {
+        for (int a = 1; a < argc; ++a) {
+            std::string arg = argv[a];
+            auto value = [&](const char* key) { return arg.substr(std::string(key).size()); };
+            if (arg.rfind("--data=", 0) == 0) c.data = value("--data=");
+            else if (arg.rfind("--out=", 0) == 0) c.out = value("--out=");
+            else if (arg.rfind("--kind=", 0) == 0) c.kind = value("--kind=");
+            else if (arg.rfind("--sizes=", 0) == 0) c.sizes = ParseIntList(value("--sizes="));
+            else if (arg.rfind("--threads=", 0) == 0) c.threads = ParseIntList(value("--threads="));
+            else if (arg.rfind("--procs=", 0) == 0) c.procs = ParseIntList(value("--procs="));
+            else if (arg.rfind("--mpi-threads=", 0) == 0) c.mpiThreads = ParseIntList(value("--mpi-threads="));
+            else if (arg.rfind("--gen=", 0) == 0) c.gen = value("--gen=");
+            else if (arg.rfind("--single=", 0) == 0) c.single = value("--single=");
+            else if (arg.rfind("--pthread=", 0) == 0) c.pthread = value("--pthread=");
+            else if (arg.rfind("--pthread-args=", 0) == 0) c.pthreadArgs = value("--pthread-args=");
+            else if (arg.rfind("--mpi=", 0) == 0) c.mpi = value("--mpi=");
+            else if (arg.rfind("--mpirun=", 0) == 0) c.mpirun = value("--mpirun=");
+            else if (arg.rfind("--lib=", 0) == 0) c.lib = value("--lib=");
+            else if (arg.rfind("--engines=", 0) == 0) c.engines = ParseList(value("--engines="));
+            else {
+                std::cerr << "Использование: bench_main [--data=DIR] [--out=FILE] [--sizes=500,1000] [--threads=1,2,4]\n"
+                          << "                  [--procs=1,2,4] [--mpi-threads=1,2] [--kind=dd|spd] [--gen=PATH] [--single=PATH]\n"
+                          << "                  [--pthread=PATH] [--pthread-args=ARGS] [--mpi=PATH] [--mpirun=CMD]\n"
+                          << "                  [--lib=PATH] [--engines=serial,threads,tiled,mpi]\n"
+                          << "Пустой путь (--mpi=) отключает решатель.\n";
+                return 1;
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    std::vector<Run> runs;
+    for (int n : c.sizes) {
+        // A.bin нужен MPI-решателю, A.txt — остальным
+        int status = 0;
+        std::string out = Execute(c.gen + " " + c.data + " --n=" + std::to_string(n) + " --kind=" + c.kind +
+                                  " --format=both", status);
+        if (status != 0) {
+            std::cerr << "Генератор завершился с кодом " << status << ":\n" << out;
+            return 2;
+        }
+
+        if (!c.single.empty())
+            runs.push_back(RunSolver("single", c.single + " " + c.data, c.data, n, 1, 1));
+        if (!c.pthread.empty())
+            for (int t : c.threads)
+                runs.push_back(RunSolver("pthread", c.pthread + " " + c.data + " --threads=" + std::to_string(t) +
+                                         (c.pthreadArgs.empty() ? "" : " " + c.pthreadArgs), c.data, n, t, 1));
+        if (!c.mpi.empty())
+            for (int p : c.procs)
+                for (int t : c.mpiThreads)
+                    runs.push_back(RunSolver("mpi", c.mpirun + " -n " + std::to_string(p) + " " + c.mpi + " " + c.data +
+                                             " --threads=" + std::to_string(t), c.data, n, t, p));
+        if (!c.lib.empty())
+            for (const std::string& e : c.engines) {
+                std::string cmd = c.lib + " " + c.data + " --engine=" + e;
+                if (e == "serial")
+                    runs.push_back(RunSolver("lib", cmd, c.data, n, 1, 1));
+                else if (e == "mpi")
+                    for (int p : c.procs)
+                        runs.push_back(RunSolver("lib", c.mpirun + " -n " + std::to_string(p) + " " + cmd + " --threads=1",
+                                                 c.data, n, 1, p));
+                else
+                    for (int t : c.threads)
+                        runs.push_back(RunSolver("lib", cmd + " --threads=" + std::to_string(t), c.data, n, t, 1));
+            }
+        WriteResults(c.out, runs);   // после каждого N, чтобы прерванный прогон не пропал
+    }
+
+    std::cout << "Результаты: " << c.out << ".csv, " << c.out << ".json\n";
+    return 0;
+}
@@ -0,0 +1,315 @@
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
+
+// Генератор тестовых систем для lab8 (замена C#-генератора из lab8_singleThread/Generator).
+// A — с диагональным преобладанием, как у C#-версии, или симметричная положительно
+// определённая (симметричная со строгим диагональным преобладанием и положительной диагональю).
+// Решение Xtrue известно заранее, B = A * Xtrue.
+// Элемент (i, j) — хеш от (seed, i, j), поэтому результат не зависит от числа потоков
+// и строки можно строить в любом порядке.
+// С --batch=K вместо одной системы пишется пакет из K независимых систем порядка N
+// (batch.bin и batchXtrue.bin) для batch_main.
+
+enum class Kind { DiagDominant, SPD };
+
+static int N;
+static uint64_t seed = 42;
+static Kind kind = Kind::DiagDominant;
+// Сдвиг ключей хеша: у каждой системы пакета свой диапазон ключей, то есть своя матрица
+static thread_local uint64_t keyBase = 0;
+
+static inline uint64_t SplitMix64(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Равномерно в [0, 1) по ключу
+static inline double Uniform(uint64_t key)
+{
+    return (SplitMix64(seed ^ SplitMix64(key + keyBase)) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static inline double OffDiagonal(int i, int j)
+{
+    if (kind == Kind::SPD && j < i) std::swap(i, j);
+    return Uniform((uint64_t)i * (uint64_t)N + (uint64_t)j) * 10 - 5;
+}
+
+static inline double Solution(int i)
+{
+    return Uniform((uint64_t)N * (uint64_t)N + (uint64_t)i) * 10 - 5;
+}
+
+// Строка i матрицы и b_i = (A * Xtrue)_i
+static double BuildRow(int i, double* row)
+{
+    double sum = 0.0;
+    for (int j = 0; j < N; ++j) {
+        if (j == i) continue;
+        row[j] = OffDiagonal(i, j);
+        sum += std::abs(row[j]);
+    }
+    row[i] = sum + Uniform(((uint64_t)N + 1) * (uint64_t)N + (uint64_t)i) * 5 + 1;
+
+    double b = 0.0;
+    for (int j = 0; j < N; ++j) b += row[j] * Solution(j);
+    return b;
+}
+
+static void WriteAt(int fd, const void* buf, size_t bytes, off_t offset)
+{
+    const char* p = (const char*)buf;
+    while (bytes > 0) {
+        ssize_t r = pwrite(fd, p, bytes, offset);
+        if (r < 0) throw std::runtime_error(std::string("pwrite: ") + std::strerror(errno));
+        p += r; bytes -= r; offset += r;
+    }
+}
+
+static void AppendNumber(std::string& out, double v)
+{
+    char buf[32];
+    int len = std::snprintf(buf, sizeof(buf), "%.17g", v);
+    out.append(buf, len);
+}
+
+// Строки раздаются потокам порциями по ROWS_PER_TASK; текст порции собирается в памяти
+// и пишется по порядку, A.bin пишется каждым потоком сразу по своему смещению.
+// A.bin собирается в A.bin.tmp и переименовывается только целым. Формат, который не
+// просили, удаляется из папки: читатели предпочитают A.bin, и оставшийся от прошлой
+// генерации файл подменил бы новую систему старой.
+static void Generate(const std::string& folder, bool text, bool binary, int threads, std::vector<double>& B)
+{
+    const int ROWS_PER_TASK = 16;
+    B.assign(N, 0.0);
+
+    std::ofstream txt;
+    if (text) {
+        txt.open(folder + "/A.txt", std::ios::binary | std::ios::trunc);
+        if (!txt) throw std::runtime_error("Cannot create A.txt");
+    }
+    const std::string binPath = folder + "/A.bin", tmpPath = binPath + ".tmp";
+    if (!binary) unlink(binPath.c_str());
+    if (!text) unlink((folder + "/A.txt").c_str());
+    int fd = -1;
+    if (binary) {
+        fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) throw std::runtime_error("Cannot create " + tmpPath);
+        long long header = N;
+        WriteAt(fd, &header, sizeof(header), 0);
+    }
+
+    std::vector<std::string> parts(threads);
+    std::vector<std::string> errors(threads);
+    for (int c0 = 0; c0 < N; c0 += threads * ROWS_PER_TASK) {
+        std::vector<std::thread> pool;
+        for (int t = 0; t < threads; ++t) {
+            pool.emplace_back([&, t] {
+                try {
+                    std::vector<double> row(N);
+                    std::string& out = parts[t];
+                    out.clear();
+                    int r0 = std::min(c0 + t * ROWS_PER_TASK, N);
+                    int r1 = std::min(r0 + ROWS_PER_TASK, N);
+                    for (int i = r0; i < r1; ++i) {
+                        B[i] = BuildRow(i, row.data());
+                        if (binary)
+                            WriteAt(fd, row.data(), (size_t)N * sizeof(double),
+                                    sizeof(long long) + (off_t)i * N * sizeof(double));
+                        if (text) {
+                            for (int j = 0; j < N; ++j) {
+                                AppendNumber(out, row[j]);
+                                out += (j + 1 < N) ? ' ' : '\n';
+                            }
+                        }
+                    }
+                }
+                catch (const std::exception& e) {
+                    errors[t] = e.what();
+                }
+            });
+        }
+        for (auto& th : pool) th.join();
+        for (auto& e : errors)
+            if (!e.empty()) {
+                if (fd >= 0) {
+                    close(fd);
+                    unlink(tmpPath.c_str());
+                }
+                throw std::runtime_error(e);
+            }
+        if (text)
+            for (auto& p : parts) txt.write(p.data(), p.size());
+    }
+    if (text) txt.close();
+    if (text && !txt) {
+        if (fd >= 0) {
+            close(fd);
+            unlink(tmpPath.c_str());
+        }
+        throw std::runtime_error("Cannot write A.txt");
+    }
+    if (fd >= 0) {
+        // A.bin не старше A.txt той же генерации: по времени изменения читатели отличают
+        // A.bin, оставшийся от прошлой генерации
+        bool ok = futimens(fd, nullptr) == 0;
+        ok = close(fd) == 0 && ok && rename(tmpPath.c_str(), binPath.c_str()) == 0;
+        if (!ok) {
+            unlink(tmpPath.c_str());
+            throw std::runtime_error("Cannot write " + binPath + ": " + std::strerror(errno));
+        }
+    }
+}
+
+static void WriteColumn(const std::string& path, const std::vector<double>& V)
+{
+    std::string out;
+    for (double v : V) {
+        AppendNumber(out, v);
+        out += '\n';
+    }
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    f.write(out.data(), out.size());
+    if (!f) throw std::runtime_error("Cannot write " + path);
+}
+
+// batch.bin: int64 K, int64 N, затем K раз по N*N double матрицы (по строкам) и N double
+// правой части; batchXtrue.bin: int64 K, int64 N, затем K раз по N double решения.
+// Системы раздаются потокам порциями, каждая порция пишется сразу по своему смещению.
+static void GenerateBatch(const std::string& folder, long long count, int threads)
+{
+    const long long SYSTEMS_PER_TASK = 4096;
+    int fd = open((folder + "/batch.bin").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    int fdx = open((folder + "/batchXtrue.bin").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || fdx < 0) throw std::runtime_error("Cannot create batch.bin");
+    long long header[2] = { count, N };
+    WriteAt(fd, header, sizeof(header), 0);
+    WriteAt(fdx, header, sizeof(header), 0);
+
+    const size_t perSystem = (size_t)N * N + N;
+    std::vector<std::string> errors(threads);
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            try {
+                std::vector<double> sys, xs;
+                for (long long s0 = t * SYSTEMS_PER_TASK; s0 < count; s0 += (long long)threads * SYSTEMS_PER_TASK) {
+                    long long s1 = std::min(s0 + SYSTEMS_PER_TASK, count);
+                    sys.resize((s1 - s0) * perSystem);
+                    xs.resize((s1 - s0) * N);
+                    for (long long s = s0; s < s1; ++s) {
+                        keyBase = (uint64_t)s * ((uint64_t)N + 2) * (uint64_t)N;
+                        double* a = sys.data() + (s - s0) * perSystem;
+                        for (int i = 0; i < N; ++i) a[(size_t)N * N + i] = BuildRow(i, a + (size_t)i * N);
+                        for (int i = 0; i < N; ++i) xs[(s - s0) * N + i] = Solution(i);
+                    }
+                    WriteAt(fd, sys.data(), sys.size() * sizeof(double), sizeof(header) + (off_t)(s0 * perSystem * sizeof(double)));
+                    WriteAt(fdx, xs.data(), xs.size() * sizeof(double), sizeof(header) + (off_t)(s0 * N * sizeof(double)));
+                }
+            }
+            catch (const std::exception& e) {
+                errors[t] = e.what();
+            }
+        });
+    }
+    for (auto& th : pool) th.join();
+    close(fd);
+    close(fdx);
+    for (auto& e : errors)
+        if (!e.empty()) throw std::runtime_error(e);
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cerr << "Ожидался аргумент — путь к папке с данными\n";
+        std::cerr << "Использование: gen_main <папка> [--n=N] [--kind=dd|spd] [--format=text|binary|both] [--threads=T] [--seed=S]\n"
+                  << "                [--batch=K]\n";
+        return 1;
+    }
+
+    std::string folder;
+    std::string format = "text";
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    long long batch = 0;
+    N = 0;
+    try {
+        for (int a = 1; a < argc; ++a) {
+            std::string arg = argv[a];
+            if (arg.rfind("--n=", 0) == 0) N = std::stoi(arg.substr(4));
+            else if (arg.rfind("--threads=", 0) == 0) threads = std::stoi(arg.substr(10));
+            else if (arg.rfind("--seed=", 0) == 0) seed = std::stoull(arg.substr(7));
+            else if (arg.rfind("--format=", 0) == 0) format = arg.substr(9);
+            else if (arg.rfind("--batch=", 0) == 0) batch = std::stoll(arg.substr(8));
+            else if (arg == "--kind=dd") kind = Kind::DiagDominant;
+            else if (arg == "--kind=spd") kind = Kind::SPD;
+            else if (arg.rfind("--kind=", 0) == 0) throw std::runtime_error("Unknown --kind value: " + arg.substr(7));
+            else folder = arg;
+        }
+        if (format != "text" && format != "binary" && format != "both")
+            throw std::runtime_error("Unknown --format value: " + format);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    if (threads <= 0) threads = 1;
+
+    // как в C#-генераторе: размер спрашивается, если не задан
+    if (N <= 0) {
+        std::cout << "Введите размер N: ";
+        std::cin >> N;
+        if (N <= 0) {
+            std::cerr << "Размер должен быть положительным\n";
+            return 1;
+        }
+    }
+
+    mkdir(folder.c_str(), 0755);
+    bool text = format != "binary";
+    bool binary = format != "text";
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    std::vector<double> B, X(N);
+    try {
+        if (batch > 0) GenerateBatch(folder, batch, threads);
+        else {
+            Generate(folder, text, binary, threads, B);
+            for (int i = 0; i < N; ++i) X[i] = Solution(i);
+            WriteColumn(folder + "/B.txt", B);
+            WriteColumn(folder + "/Xtrue.txt", X);
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 2;
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = t2 - t1;
+
+    std::cout << "==============================================\n";
+    std::cout << "Размер матрицы: " << N << "x" << N << "\n";
+    if (batch > 0) std::cout << "Систем в пакете: " << batch << "\n";
+    std::cout << "Тип: " << (kind == Kind::SPD ? "симметричная положительно определённая" : "диагональное преобладание") << "\n";
+    std::cout << "Формат: " << (batch > 0 ? std::string("batch.bin") : format) << ", потоков: " << threads << ", seed " << seed << "\n";
+    std::cout << "Время: " << elapsed.count() << " мс\n";
+    std::cout << "Файлы записаны в " << folder << "\n";
+    std::cout << "==============================================\n";
+    return 0;
+}
@@ -0,0 +1,26 @@
+#!/bin/sh
+# Сравнение чистого MPI (ранг на ядро) и гибридного режима (меньше рангов, потоки внутри)
+# при одинаковом числе ядер. Время берётся из log.txt, который пишет main.
+# Использование: ./bench_hybrid.sh <папка с данными> [ядер] [блок]
+
+DATA=$1
+CORES=${2:-$(nproc)}
+BLOCK=${3:-32}
+MPIRUN=${MPIRUN:-mpirun}
+
+if [ -z "$DATA" ]; then
+    echo "Использование: $0 <папка с данными> [ядер] [блок]"
+    exit 1
+fi
+
+printf "ranks\tthreads\ttime_ms\n"
+T=1
+while [ "$T" -le "$CORES" ]; do
+    if [ $((CORES % T)) -eq 0 ]; then
+        P=$((CORES / T))
+        $MPIRUN -n "$P" ./main "$DATA" --block="$BLOCK" --threads="$T" > /dev/null || exit 1
+        MS=$(grep "Время:" log.txt | tail -n 1 | sed 's/[^0-9]//g')
+        printf "%s\t%s\t%s\n" "$P" "$T" "$MS"
+    fi
+    T=$((T * 2))
+done
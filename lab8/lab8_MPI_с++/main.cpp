@@ -1,5 +1,7 @@
 #include <mpi.h>
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -8,55 +10,119 @@
 #include <chrono>
 #include <locale>
 #include <vector>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include <climits>
+#include <sys/stat.h>
 
 using namespace std;
 
-void logToFile(const wstring& message) {
-    const string logPath = "log.txt";
+string ToUtf8(const wstring& message) {
+#ifdef _WIN32
     int size_needed = WideCharToMultiByte(CP_UTF8, 0, message.c_str(), (int)message.size(), nullptr, 0, nullptr, nullptr);
     string utf8Str(size_needed, 0);
     WideCharToMultiByte(CP_UTF8, 0, message.c_str(), (int)message.size(), &utf8Str[0], size_needed, nullptr, nullptr);
+    return utf8Str;
+#else
+    string utf8Str;
+    for (wchar_t wc : message) {
+        unsigned int c = (unsigned int)wc;
+        if (c < 0x80) utf8Str += (char)c;
+        else if (c < 0x800) {
+            utf8Str += (char)(0xC0 | (c >> 6));
+            utf8Str += (char)(0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            utf8Str += (char)(0xE0 | (c >> 12));
+            utf8Str += (char)(0x80 | ((c >> 6) & 0x3F));
+            utf8Str += (char)(0x80 | (c & 0x3F));
+        } else {
+            utf8Str += (char)(0xF0 | (c >> 18));
+            utf8Str += (char)(0x80 | ((c >> 12) & 0x3F));
+            utf8Str += (char)(0x80 | ((c >> 6) & 0x3F));
+            utf8Str += (char)(0x80 | (c & 0x3F));
+        }
+    }
+    return utf8Str;
+#endif
+}
+
+void logToFile(const wstring& message) {
+    const string logPath = "log.txt";
     ofstream logFile(logPath, ios::app);
     if (!logFile.is_open()) return;
-    logFile << utf8Str << endl;
+    logFile << ToUtf8(message) << endl;
     logFile.close();
 }
 
-void ReadMatrix(const std::string& path, double**& A, int& N)
+void ConvertTextToBinaryFile(const string& txtPath, const string& binPath)
 {
-    ifstream fin(path);
-    if (!fin) throw std::runtime_error("Cannot open " + path);
+    ifstream fin(txtPath);
+    if (!fin) throw std::runtime_error("Cannot open " + txtPath);
+    ofstream fout(binPath, ios::binary | ios::trunc);
+    if (!fout) throw std::runtime_error("Cannot create " + binPath);
+    long long N = 0;
+    fout.write((const char*)&N, sizeof(N));
 
     string line;
-    vector<vector<double>> rows;
-
+    vector<double> row;
+    long long rows = 0;
     while (std::getline(fin, line))
     {
         istringstream ss(line);
-        vector<double> row;
+        row.clear();
         double v;
-
         while (ss >> v) row.push_back(v);
+        if (row.empty()) continue;
 
-        if (!row.empty())
-            rows.push_back(std::move(row));
+        if (rows == 0) N = (long long)row.size();
+        else if ((long long)row.size() != N) throw std::runtime_error("Matrix is not square");
+        fout.write((const char*)row.data(), row.size() * sizeof(double));
+        rows++;
     }
 
-    N = (int)rows.size();
     if (N == 0) throw std::runtime_error("Matrix file is empty");
+    if (rows != N) throw std::runtime_error("Matrix is not square");
+    fout.seekp(0);
+    fout.write((const char*)&N, sizeof(N));
+    if (!fout.flush()) throw std::runtime_error("Cannot write " + binPath);
+}
 
-    for (int i = 0; i < N; i++)
-        if ((int)rows[i].size() != N)
-            throw std::runtime_error("Matrix is not square");
-
-    A = new double*[N];
-    for (int i = 0; i < N; i++)
-        A[i] = new double[N];
+// Время изменения файла в наносекундах; -1 — файла нет
+long long ModifiedNs(const string& path)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return -1;
+#ifdef _WIN32
+    return (long long)st.st_mtime * 1000000000LL;
+#else
+    return (long long)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#endif
+}
 
-    
-    for (int i = 0; i < N; i++)
-        for (int j = 0; j < N; j++)
-            A[i][j] = rows[i][j];
+// Потоковое преобразование A.txt в двоичный A.bin: заголовок int64 N, затем N*N double
+// по строкам. В памяти держится только одна строка. Пишется в A.bin.tmp и переименовывается
+// только целым: недописанный A.bin следующий запуск принял бы за готовый.
+void ConvertTextToBinary(const string& txtPath, const string& binPath)
+{
+    const string tmpPath = binPath + ".tmp";
+    try {
+        ConvertTextToBinaryFile(txtPath, tmpPath);
+    }
+    catch (...) {
+        std::remove(tmpPath.c_str());
+        throw;
+    }
+#ifdef _WIN32
+    std::remove(binPath.c_str());
+#endif
+    if (std::rename(tmpPath.c_str(), binPath.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        throw std::runtime_error("Cannot rename " + tmpPath + " to " + binPath);
+    }
 }
 
 void ReadVector(const std::string& path, double*& B, int N)
@@ -78,43 +144,412 @@ void WriteVector(const string& path, double* X, int N) {
     for (int i = 0; i < N; i++) fout << X[i] << "\n";
 }
 
-void LocalGaussianElimination(double** ALocal, double* B, int* myColumns, int localCols, int N, int rank, int size, MPI_Comm comm) {
+// Двумерное блочно-циклическое распределение: блок (I, J) размера nb x nb
+// принадлежит процессу (I % Pr, J % Pc) решётки Pr x Pc.
+// Вектор B хранится как столбец N расширенной матрицы [A | B].
+struct Grid {
+    int Pr, Pc;          // размеры решётки процессов
+    int myRow, myCol;    // координаты текущего процесса
+    int nb;              // размер блока
+    MPI_Comm rowComm;    // процессы той же строки решётки (ранг = myCol)
+    MPI_Comm colComm;    // процессы того же столбца решётки (ранг = myRow)
+};
+
+// Сколько из первых n глобальных индексов достаётся процессу p из P
+int NumLocal(int n, int nb, int p, int P) {
+    int blocks = n / nb;
+    int num = (blocks / P) * nb;
+    int extra = blocks % P;
+    if (p < extra) num += nb;
+    else if (p == extra) num += n % nb;
+    return num;
+}
+
+int OwnerOf(int g, int nb, int P) { return (g / nb) % P; }
+int LocalIndex(int g, int nb, int P) { return (g / (nb * P)) * nb + g % nb; }
+int GlobalIndex(int l, int nb, int p, int P) { return (l / nb) * nb * P + p * nb + l % nb; }
+
+// Буферы шага k: часть строки k (столбцы >= k) и множители строк ниже k.
+// Используются два комплекта по очереди, пока шаг k+1 рассылается, шаг k ещё считается.
+struct StepBuffers {
+    double* row;
+    double* mult;
+    MPI_Request rowReq;
+    MPI_Request multReq;
+};
+
+// Рассылка строки k по столбцу решётки (akk и bk едут в этом же сообщении)
+void PostRowBcast(double* ALocal, int locCols, int k, const Grid& g, StepBuffers& sb) {
+    int rowOwner = OwnerOf(k, g.nb, g.Pr);
+    int lj0 = NumLocal(k, g.nb, g.myCol, g.Pc);
+    if (g.myRow == rowOwner) {
+        int lk = LocalIndex(k, g.nb, g.Pr);
+        copy(ALocal + (size_t)lk * locCols + lj0, ALocal + (size_t)lk * locCols + locCols, sb.row);
+    }
+    MPI_Ibcast(sb.row, locCols - lj0, MPI_DOUBLE, rowOwner, g.colComm, &sb.rowReq);
+}
+
+// Множители столбца k; владельцы столбца сначала дожидаются akk из строки k
+void PostMultBcast(double* ALocal, int locRows, int locCols, int k, const Grid& g, StepBuffers& sb, double& waitTime) {
+    int colOwner = OwnerOf(k, g.nb, g.Pc);
+    int li0 = NumLocal(k + 1, g.nb, g.myRow, g.Pr);
+    if (g.myCol == colOwner) {
+        double w0 = MPI_Wtime();
+        MPI_Wait(&sb.rowReq, MPI_STATUS_IGNORE);
+        waitTime += MPI_Wtime() - w0;
+
+        double akk = sb.row[0];
+        if (akk == 0.0) throw runtime_error("Нулевой главный элемент в строке " + to_string(k));
+        int lk = LocalIndex(k, g.nb, g.Pc);
+        for (int i = li0; i < locRows; i++) {
+            double factor = ALocal[(size_t)i * locCols + lk] / akk;
+            ALocal[(size_t)i * locCols + lk] = factor;
+            sb.mult[i - li0] = factor;
+        }
+    }
+    MPI_Ibcast(sb.mult, locRows - li0, MPI_DOUBLE, colOwner, g.rowComm, &sb.multReq);
+}
+
+// Обновление прямоугольника [i0, i1) x [j0, j1) данными шага k
+void UpdateRange(double* ALocal, int locCols, int i0, int i1, int j0, int j1,
+                 const double* rowK, int rowShift, const double* mult, int multShift) {
+    for (int i = i0; i < i1; i++) {
+        double factor = mult[i - multShift];
+        if (factor == 0.0) continue;
+        double* row = ALocal + (size_t)i * locCols;
+        for (int j = j0; j < j1; j++)
+            row[j] -= factor * rowK[j - rowShift];
+    }
+}
+
+// Пул потоков ранга для гибридного режима MPI + потоки. Обменами занимается только
+// главный поток (MPI_THREAD_FUNNELED): он раздаёт строки хвоста помощникам, сам считает
+// свою порцию и между кусками дёргает MPI_Test, продвигая рассылки следующего шага.
+class UpdatePool {
+public:
+    explicit UpdatePool(int threads) : numThreads(max(threads, 1)) {
+        for (int t = 1; t < numThreads; t++) helpers.emplace_back(&UpdatePool::HelperRoutine, this, t);
+    }
+
+    ~UpdatePool() {
+        {
+            lock_guard<mutex> lock(m);
+            terminate = true;
+            generation++;
+        }
+        cvStart.notify_all();
+        for (auto& th : helpers) th.join();
+    }
+
+    int Threads() const { return numThreads; }
+
+    // Обновить строки [i0, i1) x [j0, locCols); progress вызывается главным потоком между кусками
+    template <class Progress>
+    void Run(double* A, int locCols, int i0, int i1, int j0, const double* rowK, int rowShift,
+             const double* mult, int multShift, Progress progress) {
+        job = { A, locCols, i0, i1, j0, rowK, rowShift, mult, multShift };
+        if (numThreads > 1) {
+            lock_guard<mutex> lock(m);
+            pending = numThreads - 1;
+            generation++;
+        }
+        cvStart.notify_all();
+
+        int c0, c1;
+        Chunk(0, c0, c1);
+        const int slice = 16;
+        for (int s = c0; s < c1; s += slice) {
+            UpdateRange(A, locCols, s, min(s + slice, c1), j0, locCols, rowK, rowShift, mult, multShift);
+            progress();
+        }
+
+        if (numThreads > 1) {
+            unique_lock<mutex> lock(m);
+            cvDone.wait(lock, [this] { return pending == 0; });
+        }
+    }
+
+private:
+    struct Job {
+        double* A;
+        int locCols, i0, i1, j0;
+        const double* rowK;
+        int rowShift;
+        const double* mult;
+        int multShift;
+    };
+
+    void Chunk(int t, int& c0, int& c1) const {
+        int rows = job.i1 - job.i0;
+        int per = (rows + numThreads - 1) / numThreads;
+        c0 = min(job.i0 + t * per, job.i1);
+        c1 = min(c0 + per, job.i1);
+    }
+
+    void HelperRoutine(int t) {
+        long seen = 0;
+        while (true) {
+            {
+                unique_lock<mutex> lock(m);
+                cvStart.wait(lock, [&] { return generation != seen; });
+                seen = generation;
+                if (terminate) return;
+            }
+            int c0, c1;
+            Chunk(t, c0, c1);
+            UpdateRange(job.A, job.locCols, c0, c1, job.j0, job.locCols, job.rowK, job.rowShift, job.mult, job.multShift);
+            {
+                lock_guard<mutex> lock(m);
+                if (--pending == 0) cvDone.notify_one();
+            }
+        }
+    }
+
+    int numThreads;
+    vector<thread> helpers;
+    mutex m;
+    condition_variable cvStart, cvDone;
+    long generation = 0;
+    int pending = 0;
+    bool terminate = false;
+    Job job{};
+};
+
+double LocalGaussianElimination(double* ALocal, int locRows, int locCols, int N, const Grid& g, UpdatePool& pool) {
+    StepBuffers sb[2];
+    for (auto& b : sb) {
+        b.row = new double[locCols > 0 ? locCols : 1];
+        b.mult = new double[locRows > 0 ? locRows : 1];
+    }
+    double waitTime = 0.0;
+
+    PostRowBcast(ALocal, locCols, 0, g, sb[0]);
+    PostMultBcast(ALocal, locRows, locCols, 0, g, sb[0], waitTime);
+
     for (int k = 0; k < N; k++) {
-        int columnOwner = k % size;
-        double* pivotRow = new double[N];
-        double akk = 0.0;
-        double bk = 0.0;
-
-        if (rank == columnOwner) {
-            int localK = -1;
-            for (int j = 0; j < localCols; j++) if (myColumns[j] == k) { localK = j; break; }
-            if (localK == -1) throw runtime_error("Столбец не найден у владельца");
-            for (int j = 0; j < localCols; j++) pivotRow[myColumns[j]] = ALocal[k][j];
-            akk = pivotRow[k];
-            bk = B[k];
+        StepBuffers& cur = sb[k % 2];
+        double w0 = MPI_Wtime();
+        MPI_Wait(&cur.rowReq, MPI_STATUS_IGNORE);
+        MPI_Wait(&cur.multReq, MPI_STATUS_IGNORE);
+        waitTime += MPI_Wtime() - w0;
+
+        int lj0 = NumLocal(k, g.nb, g.myCol, g.Pc);
+        int li0 = NumLocal(k + 1, g.nb, g.myRow, g.Pr);
+        int lj1 = NumLocal(k + 1, g.nb, g.myCol, g.Pc);
+        int iRest = li0;
+        int jRest = lj1;
+        StepBuffers& next = sb[(k + 1) % 2];
+
+        if (k + 1 < N) {
+            // Опережение: сначала строка и столбец k+1, затем их рассылка
+            bool ownRow = (g.myRow == OwnerOf(k + 1, g.nb, g.Pr));
+            bool ownCol = (g.myCol == OwnerOf(k + 1, g.nb, g.Pc));
+            if (ownRow) {
+                UpdateRange(ALocal, locCols, li0, li0 + 1, lj1, locCols, cur.row, lj0, cur.mult, li0);
+                iRest = li0 + 1;
+            }
+            if (ownCol) {
+                UpdateRange(ALocal, locCols, iRest, locRows, lj1, lj1 + 1, cur.row, lj0, cur.mult, li0);
+                jRest = lj1 + 1;
+            }
+
+            PostRowBcast(ALocal, locCols, k + 1, g, next);
+            PostMultBcast(ALocal, locRows, locCols, k + 1, g, next, waitTime);
+        }
+
+        // Остаток хвоста шага k, пока шаг k+1 в пути
+        bool inFlight = (k + 1 < N);
+        pool.Run(ALocal, locCols, iRest, locRows, jRest, cur.row, lj0, cur.mult, li0, [&] {
+            if (!inFlight) return;
+            int flag;
+            MPI_Test(&next.rowReq, &flag, MPI_STATUS_IGNORE);
+            MPI_Test(&next.multReq, &flag, MPI_STATUS_IGNORE);
+        });
+    }
+
+    for (auto& b : sb) {
+        delete[] b.row;
+        delete[] b.mult;
+    }
+    return waitTime;
+}
+
+// Распределённый обратный ход. Каждый ранг копит частичные суммы U(i, j) * x_j
+// по своим столбцам; для блока J они складываются вдоль строки решётки на владельце
+// диагонального блока, тот решает блок и рассылает x_J по своему столбцу решётки.
+// Суммы для следующего блока досчитываются первыми и уходят неблокирующим Ireduce,
+// пока остальные строки ещё обновляются. Возвращает x диагональных блоков ранга.
+vector<double> DistributedBackSubstitution(double* ALocal, int locRows, int locCols, int N, const Grid& g) {
+    int T = (N + g.nb - 1) / g.nb;
+    vector<double> partial(max(locRows, 1), 0.0);
+    vector<double> reduced(g.nb), xJ(g.nb);
+    vector<double> myX;
+
+    // Правая часть y (столбец N) входит в суммы со знаком минус
+    if (g.myCol == OwnerOf(N, g.nb, g.Pc)) {
+        int ly = LocalIndex(N, g.nb, g.Pc);
+        for (int i = 0; i < locRows; i++) partial[i] = -ALocal[(size_t)i * locCols + ly];
+    }
+
+    auto blockRows = [&](int J) { return min(g.nb, N - J * g.nb); };
+    MPI_Request req = MPI_REQUEST_NULL;
+
+    if (g.myRow == OwnerOf((T - 1) * g.nb, g.nb, g.Pr)) {
+        int lo = NumLocal((T - 1) * g.nb, g.nb, g.myRow, g.Pr);
+        MPI_Ireduce(partial.data() + lo, reduced.data(), blockRows(T - 1), MPI_DOUBLE, MPI_SUM,
+                    OwnerOf((T - 1) * g.nb, g.nb, g.Pc), g.rowComm, &req);
+    }
+
+    for (int J = T - 1; J >= 0; J--) {
+        int h = blockRows(J);
+        int pr = J % g.Pr, pc = J % g.Pc;
+
+        if (g.myRow == pr) MPI_Wait(&req, MPI_STATUS_IGNORE);
+
+        if (g.myRow == pr && g.myCol == pc) {
+            int li = LocalIndex(J * g.nb, g.nb, g.Pr);
+            int lj = LocalIndex(J * g.nb, g.nb, g.Pc);
+            for (int r = h - 1; r >= 0; r--) {
+                const double* row = ALocal + (size_t)(li + r) * locCols + lj;
+                double sum = -reduced[r];
+                for (int c = r + 1; c < h; c++) sum -= row[c] * xJ[c];
+                xJ[r] = sum / row[r];
+            }
+            myX.insert(myX.end(), xJ.begin(), xJ.begin() + h);
         }
 
-        MPI_Bcast(pivotRow, N, MPI_DOUBLE, columnOwner, comm);
-        MPI_Bcast(&akk, 1, MPI_DOUBLE, columnOwner, comm);
-        MPI_Bcast(&bk, 1, MPI_DOUBLE, columnOwner, comm);
+        if (g.myCol != pc) {
+            // этот столбец решётки в блоке J ничего не добавляет
+            if (J > 0 && g.myRow == (J - 1) % g.Pr) {
+                int lo = NumLocal((J - 1) * g.nb, g.nb, g.myRow, g.Pr);
+                MPI_Ireduce(partial.data() + lo, reduced.data(), blockRows(J - 1), MPI_DOUBLE, MPI_SUM,
+                            (J - 1) % g.Pc, g.rowComm, &req);
+            }
+            continue;
+        }
+
+        MPI_Bcast(xJ.data(), h, MPI_DOUBLE, pr, g.colComm);
+
+        int lj = LocalIndex(J * g.nb, g.nb, g.Pc);
+        auto accumulate = [&](int i0, int i1) {
+            for (int i = i0; i < i1; i++) {
+                const double* row = ALocal + (size_t)i * locCols + lj;
+                double sum = 0.0;
+                for (int c = 0; c < h; c++) sum += row[c] * xJ[c];
+                partial[i] += sum;
+            }
+        };
+
+        int hi = NumLocal(J * g.nb, g.nb, g.myRow, g.Pr);
+        int lo = (J > 0) ? NumLocal((J - 1) * g.nb, g.nb, g.myRow, g.Pr) : hi;
+        accumulate(lo, hi);
+        if (J > 0 && g.myRow == (J - 1) % g.Pr)
+            MPI_Ireduce(partial.data() + lo, reduced.data(), blockRows(J - 1), MPI_DOUBLE, MPI_SUM,
+                        (J - 1) % g.Pc, g.rowComm, &req);
+        accumulate(0, lo);
+    }
+
+    return myX;
+}
+
+// Сбор x на ранг 0: у каждого ранга его диагональные блоки в порядке убывания J
+void GatherSolution(const vector<double>& myX, int N, const Grid& g, int rank, int size, double* X) {
+    int T = (N + g.nb - 1) / g.nb;
+    int myCount = (int)myX.size();
+    vector<int> counts(rank == 0 ? size : 0), displs(rank == 0 ? size : 0);
+    MPI_Gather(&myCount, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+    vector<double> all;
+    if (rank == 0) {
+        int total = 0;
+        for (int p = 0; p < size; p++) { displs[p] = total; total += counts[p]; }
+        all.resize(max(total, 1));
+    }
+    MPI_Gatherv(myX.data(), myCount, MPI_DOUBLE, all.data(), counts.data(), displs.data(), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+    if (rank != 0) return;
+    vector<int> pos(displs);
+    for (int J = T - 1; J >= 0; J--) {
+        int p = (J % g.Pr) * g.Pc + J % g.Pc;
+        int h = min(g.nb, N - J * g.nb);
+        copy(all.begin() + pos[p], all.begin() + pos[p] + h, X + J * g.nb);
+        pos[p] += h;
+    }
+}
 
-        for (int i = k + 1; i < N; i++) {
-            double factor = pivotRow[k] / akk;
-            for (int j = 0; j < localCols; j++)
-                ALocal[i][j] -= factor * pivotRow[myColumns[j]];
-            B[i] -= factor * bk;
+// Сложение по Ноймайеру: s + comp — сумма с поправкой на потерянные младшие биты
+inline void NeumaierAdd(double& s, double& comp, double v) {
+    double t = s + v;
+    if (abs(s) >= abs(v)) comp += (s - t) + v;
+    else comp += (v - t) + s;
+    s = t;
+}
+
+struct VerifyResult {
+    double residualNorm = 0.0;   // ||b - Ax||_inf
+    double backwardError = 0.0;  // ||b - Ax|| / (||A|| ||x|| + ||b||)
+};
+
+// Проверка по нетронутой копии локальных блоков [A|B]; X должен быть у всех рангов.
+// Каждый ранг считает компенсированные частичные суммы по своим столбцам (блоками,
+// чтобы кусок X оставался в кэше), суммы собираются вдоль строки решётки.
+VerifyResult DistributedVerify(const double* A0, int locRows, int locCols, int N, const Grid& g, const double* X) {
+    const int COL_BLOCK = 512;
+    int locColsA = NumLocal(N, g.nb, g.myCol, g.Pc);
+    vector<double> sum(2 * (size_t)locRows, 0.0), comp(locRows, 0.0);   // [суммы | модули строк]
+
+    if (g.myCol == OwnerOf(N, g.nb, g.Pc)) {
+        int ly = LocalIndex(N, g.nb, g.Pc);
+        for (int i = 0; i < locRows; i++) sum[i] = A0[(size_t)i * locCols + ly];
+    }
+    for (int l0 = 0; l0 < locColsA; l0 += COL_BLOCK) {
+        int l1 = min(l0 + COL_BLOCK, locColsA);
+        for (int i = 0; i < locRows; i++) {
+            const double* row = A0 + (size_t)i * locCols;
+            double a = 0.0;
+            for (int l = l0; l < l1; l++) {
+                a += abs(row[l]);
+                if (row[l] != 0.0) NeumaierAdd(sum[i], comp[i], -row[l] * X[GlobalIndex(l, g.nb, g.myCol, g.Pc)]);
+            }
+            sum[locRows + i] += a;
+        }
+    }
+    for (int i = 0; i < locRows; i++) sum[i] += comp[i];
+    MPI_Allreduce(MPI_IN_PLACE, sum.data(), (int)sum.size(), MPI_DOUBLE, MPI_SUM, g.rowComm);
+
+    // norms = { ||r||, ||A||, ||b|| } по своим строкам; NaN превращаем в бесконечность, чтобы не потерять в max
+    double norms[3] = { 0.0, 0.0, 0.0 };
+    if (g.myCol == 0) {
+        for (int i = 0; i < locRows; i++) {
+            norms[0] = max(norms[0], isfinite(sum[i]) ? abs(sum[i]) : HUGE_VAL);
+            norms[1] = max(norms[1], sum[locRows + i]);
         }
-        delete[] pivotRow;
-        MPI_Barrier(comm);
     }
+    if (g.myCol == OwnerOf(N, g.nb, g.Pc)) {
+        int ly = LocalIndex(N, g.nb, g.Pc);
+        for (int i = 0; i < locRows; i++) norms[2] = max(norms[2], abs(A0[(size_t)i * locCols + ly]));
+    }
+    MPI_Allreduce(MPI_IN_PLACE, norms, 3, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+    double normX = 0.0;
+    for (int i = 0; i < N; i++) normX = max(normX, isfinite(X[i]) ? abs(X[i]) : HUGE_VAL);
+
+    VerifyResult vr;
+    vr.residualNorm = norms[0];
+    double denom = norms[1] * normX + norms[2];
+    vr.backwardError = !isfinite(normX) ? HUGE_VAL : (denom > 0.0 ? norms[0] / denom : norms[0]);
+    return vr;
 }
 
 int main(int argc, char* argv[]) {
+#ifdef _WIN32
     SetConsoleOutputCP(CP_UTF8);
     SetConsoleCP(CP_UTF8);
+#endif
     setlocale(LC_ALL, "");
 
-    MPI_Init(&argc, &argv);
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
     int rank, size;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
@@ -129,108 +564,217 @@ int main(int argc, char* argv[]) {
     string fileA = folder + "/A.txt";
     string fileB = folder + "/B.txt";
     string fileX = folder + "/X.txt";
+    string fileBin = folder + "/A.bin";
+
+    Grid g;
+    g.nb = 32;
+    string checkPath;
+    int threadsPerRank = 1;   // 1 — чистый MPI, больше — гибридный режим
+    bool verify = false;
+    double verifyTol = 1e-10;
+    for (int a = 2; a < argc; a++) {
+        string arg = argv[a];
+        if (arg.rfind("--block=", 0) == 0) g.nb = max(1, stoi(arg.substr(8)));
+        else if (arg.rfind("--check=", 0) == 0) checkPath = arg.substr(8);
+        else if (arg.rfind("--threads=", 0) == 0) threadsPerRank = max(1, stoi(arg.substr(10)));
+        else if (arg == "--verify") verify = true;
+        else if (arg.rfind("--verify=", 0) == 0) { verify = true; verifyTol = stod(arg.substr(9)); }
+    }
+
+    // Решётка процессов Pr x Pc, максимально близкая к квадратной
+    int dims[2] = { 0, 0 };
+    MPI_Dims_create(size, 2, dims);
+    g.Pr = dims[0];
+    g.Pc = dims[1];
+    g.myRow = rank / g.Pc;
+    g.myCol = rank % g.Pc;
+    MPI_Comm_split(MPI_COMM_WORLD, g.myRow, g.myCol, &g.rowComm);
+    MPI_Comm_split(MPI_COMM_WORLD, g.myCol, g.myRow, &g.colComm);
+
+    if (threadsPerRank > 1 && provided < MPI_THREAD_FUNNELED) {
+        if (rank == 0) logToFile(L"MPI не поддерживает MPI_THREAD_FUNNELED, работаем без потоков");
+        threadsPerRank = 1;
+    }
 
-    double** A = nullptr;
     double* B = nullptr;
     int N = 0;
 
     if (rank == 0) {
-        logToFile(L"[ROOT] Чтение матрицы...");
-        ReadMatrix(fileA, A, N);
-        B = new double[N];
-        ReadVector(fileB, B, N);
-        logToFile(L"[ROOT] Матрица считана");
+        // A.bin пересобирается, если его нет или A.txt правили после него
+        long long binTime = ModifiedNs(fileBin), txtTime = ModifiedNs(fileA);
+        if (binTime < 0 || txtTime > binTime) {
+            logToFile(binTime < 0 ? L"[ROOT] Преобразование A.txt в A.bin..."
+                                  : L"[ROOT] A.txt новее A.bin, преобразование заново...");
+            double c0 = MPI_Wtime();
+            try {
+                ConvertTextToBinary(fileA, fileBin);
+            }
+            catch (const exception& e) {
+                string what = e.what();
+                logToFile(L"[ROOT] Ошибка преобразования: " + wstring(what.begin(), what.end()));
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            logToFile(L"[ROOT] A.bin записан за " + to_wstring((long long)((MPI_Wtime() - c0) * 1000)) + L" мс");
+        }
     }
+    MPI_Barrier(MPI_COMM_WORLD);
 
-    double startTime = MPI_Wtime();
-
-    MPI_Bcast(&N, 1, MPI_INT, 0, MPI_COMM_WORLD);
-    if (rank != 0) B = new double[N];
-    MPI_Bcast(B, N, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-
-    // Распределение столбцов
-    int localCols = (N + size - 1 - rank) / size;
-    int* myColumns = new int[localCols];
-    for (int j = 0, idx = 0; j < N; j++) if (j % size == rank) myColumns[idx++] = j;
-
-    double** ALocal = new double*[N];
-    for (int i = 0; i < N; i++) ALocal[i] = new double[localCols];
+    double loadStart = MPI_Wtime();
 
+    // Каждый ранг читает свои блоки сам: вид файла совпадает с блочно-циклическим распределением
+    MPI_File fh;
+    if (MPI_File_open(MPI_COMM_WORLD, fileBin.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == 0) logToFile(L"Не удалось открыть A.bin");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    long long header = 0;
     if (rank == 0) {
-        for (int i = 0; i < N; i++)
-            for (int j = 0; j < localCols; j++)
-                ALocal[i][j] = A[i][myColumns[j]];
-
-        for (int p = 1; p < size; p++) {
-            int pCols = (N + size - 1 - p) / size;
-            int* cols = new int[pCols];
-            for (int j = 0, idx = 0; j < N; j++) if (j % size == p) cols[idx++] = j;
-
-            double* columnData = new double[N * pCols];
-            for (int i = 0; i < N; i++)
-                for (int j = 0; j < pCols; j++)
-                    columnData[i * pCols + j] = A[i][cols[j]];
-
-            MPI_Send(&pCols, 1, MPI_INT, p, 0, MPI_COMM_WORLD);
-            MPI_Send(cols, pCols, MPI_INT, p, 1, MPI_COMM_WORLD);
-            MPI_Send(columnData, N * pCols, MPI_DOUBLE, p, 2, MPI_COMM_WORLD);
-
-            delete[] cols;
-            delete[] columnData;
-        }
-
-            logToFile(L"[ROOT] Столбцы распределены. Моё кол-во столбцов - " + to_wstring(localCols) + L" столбцов");
+        MPI_Offset fileSize = 0;
+        MPI_File_get_size(fh, &fileSize);
+        MPI_File_read_at(fh, 0, &header, 1, MPI_LONG_LONG, MPI_STATUS_IGNORE);
+        // заголовок не сходится с длиной файла — считаем его испорченным
+        if (header <= 0 || header > INT_MAX ||
+            (long long)fileSize != (long long)sizeof(long long) + header * header * (long long)sizeof(double))
+            header = -header - 1;
+    }
+    MPI_Bcast(&header, 1, MPI_LONG_LONG, 0, MPI_COMM_WORLD);
+    if (header <= 0) {
+        if (rank == 0) logToFile(L"[ROOT] Неверный заголовок A.bin (N = " + to_wstring(-header - 1) + L") — удалите A.bin");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    N = (int)header;
+    int M = N + 1;
+
+    int locRows = NumLocal(N, g.nb, g.myRow, g.Pr);
+    int locCols = NumLocal(M, g.nb, g.myCol, g.Pc);
+    int locColsA = NumLocal(N, g.nb, g.myCol, g.Pc);
+    double* ALocal = new double[max((size_t)locRows * locCols, (size_t)1)];
+
+    int gsizes[2] = { N, N };
+    int distribs[2] = { MPI_DISTRIBUTE_CYCLIC, MPI_DISTRIBUTE_CYCLIC };
+    int dargs[2] = { g.nb, g.nb };
+    int psizes[2] = { g.Pr, g.Pc };
+    MPI_Datatype fileType, memType;
+    MPI_Type_create_darray(size, rank, 2, gsizes, distribs, dargs, psizes, MPI_ORDER_C, MPI_DOUBLE, &fileType);
+    MPI_Type_commit(&fileType);
+    // в памяти строка длиннее на столбец B, если он наш
+    MPI_Type_vector(locRows, locColsA, locCols, MPI_DOUBLE, &memType);
+    MPI_Type_commit(&memType);
+
+    MPI_File_set_view(fh, sizeof(long long), MPI_DOUBLE, fileType, "native", MPI_INFO_NULL);
+    MPI_File_read_all(fh, ALocal, 1, memType, MPI_STATUS_IGNORE);
+    MPI_File_close(&fh);
+    MPI_Type_free(&fileType);
+    MPI_Type_free(&memType);
 
-    } else {
-        int colCount;
-        MPI_Recv(&colCount, 1, MPI_INT, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-        MPI_Recv(myColumns, colCount, MPI_INT, 0, 1, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    B = new double[N];
+    if (rank == 0) {
+        double* tmp = nullptr;
+        ReadVector(fileB, tmp, N);
+        copy(tmp, tmp + N, B);
+        delete[] tmp;
+    }
+    MPI_Bcast(B, N, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    if (g.myCol == OwnerOf(N, g.nb, g.Pc)) {
+        int ly = LocalIndex(N, g.nb, g.Pc);
+        for (int i = 0; i < locRows; i++)
+            ALocal[(size_t)i * locCols + ly] = B[GlobalIndex(i, g.nb, g.myRow, g.Pr)];
+    }
+    delete[] B;
 
-        double* columnData = new double[N * colCount];
-        MPI_Recv(columnData, N * colCount, MPI_DOUBLE, 0, 2, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    double loadTime = MPI_Wtime() - loadStart;
+    double maxLoadTime = 0.0;
+    MPI_Reduce(&loadTime, &maxLoadTime, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    if (rank == 0)
+        logToFile(L"[ROOT] Загрузка (MPI-IO): " + to_wstring((long long)(maxLoadTime * 1000)) + L" мс. Решётка " +
+                  to_wstring(g.Pr) + L"x" + to_wstring(g.Pc) + L", блок " + to_wstring(g.nb));
 
-        for (int i = 0; i < N; i++)
-            for (int j = 0; j < colCount; j++)
-                ALocal[i][j] = columnData[i * colCount + j];
+    // для проверки нужна копия до исключения, вместе со столбцом B
+    vector<double> pristine;
+    if (verify) pristine.assign(ALocal, ALocal + (size_t)locRows * locCols);
 
-        logToFile(L"[WORKER " + to_wstring(rank) + L"] Получено " + to_wstring(colCount) + L" столбцов");
+    double startTime = MPI_Wtime();
 
-        delete[] columnData;
+    double elimStart = MPI_Wtime();
+    double waitTime;
+    {
+        UpdatePool pool(threadsPerRank);
+        waitTime = LocalGaussianElimination(ALocal, locRows, locCols, N, g, pool);
     }
+    double elimTime = MPI_Wtime() - elimStart;
 
-    MPI_Barrier(MPI_COMM_WORLD);
-
-    LocalGaussianElimination(ALocal, B, myColumns, localCols, N, rank, size, MPI_COMM_WORLD);
+    // Время ожидания рассылок на каждом ранге
+    vector<double> waits(rank == 0 ? size : 0);
+    MPI_Gather(&waitTime, 1, MPI_DOUBLE, waits.data(), 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+        for (int p = 0; p < size; p++)
+            logToFile(L"[RANK " + to_wstring(p) + L"] Ожидание рассылок: " + to_wstring((long long)(waits[p] * 1000)) +
+                      L" мс из " + to_wstring((long long)(elimTime * 1000)) + L" мс прямого хода");
+    }
 
-    MPI_Barrier(MPI_COMM_WORLD);
+    vector<double> myX = DistributedBackSubstitution(ALocal, locRows, locCols, N, g);
+    double* X = (rank == 0 || verify) ? new double[N] : nullptr;
+    GatherSolution(myX, N, g, rank, size, X);
+    double solveEnd = MPI_Wtime();
 
     if (rank == 0) {
-        double* X = new double[N];
-        for (int i = N - 1; i >= 0; i--) {
-            double sum = B[i];
-            for (int j = i + 1; j < N; j++)
-                sum -= ALocal[i % N][j % localCols] * X[j]; 
-            X[i] = sum / ALocal[i % N][i % localCols];
-        }
         WriteVector(fileX, X, N);
-        delete[] X;
-
         double endTime = MPI_Wtime();
+
+        if (!checkPath.empty()) {
+            // Сравнение с решением однопоточного решателя
+            double* Xref = nullptr;
+            ReadVector(checkPath, Xref, N);
+            double maxDiff = 0.0, maxRef = 0.0;
+            for (int i = 0; i < N; i++) {
+                maxDiff = max(maxDiff, abs(X[i] - Xref[i]));
+                maxRef = max(maxRef, abs(Xref[i]));
+            }
+            delete[] Xref;
+            wostringstream ws;
+            ws << L"[ROOT] Сверка с " << wstring(checkPath.begin(), checkPath.end())
+               << L": max|X - Xref| = " << maxDiff << L", относительная " << (maxRef > 0 ? maxDiff / maxRef : maxDiff);
+            logToFile(ws.str());
+        }
+
         logToFile(L"==============================================");
         logToFile(L"  Размер матрицы: " + to_wstring(N) + L"x" + to_wstring(N));
-        logToFile(L"  Процессов: " + to_wstring(size));
+        logToFile(L"  Процессов: " + to_wstring(size) + L" (решётка " + to_wstring(g.Pr) + L"x" + to_wstring(g.Pc) + L")");
+        logToFile(L"  Режим: " + wstring(threadsPerRank > 1 ? L"MPI + потоки, " : L"чистый MPI, ") +
+                  to_wstring(threadsPerRank) + L" потоков на ранг");
         logToFile(L"  Время: " + to_wstring((long long)((endTime - startTime) * 1000)) + L" мс");
         logToFile(L"==============================================");
+
+        // строка для lab8_Bench_с++
+        cout << "TIMINGS engine=mpi n=" << N << " threads=" << threadsPerRank << " procs=" << size
+             << " load_ms=" << maxLoadTime * 1000 << " factor_ms=" << elimTime * 1000
+             << " solve_ms=" << (solveEnd - elimStart - elimTime) * 1000
+             << " write_ms=" << (endTime - solveEnd) * 1000 << endl;
+    }
+
+    bool failed = false;
+    if (verify) {
+        double v0 = MPI_Wtime();
+        MPI_Bcast(X, N, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        VerifyResult vr = DistributedVerify(pristine.data(), locRows, locCols, N, g, X);
+        double verifyTime = MPI_Wtime() - v0;
+        failed = !(vr.backwardError <= verifyTol);   // результат Allreduce одинаков на всех рангах
+        if (rank == 0) {
+            wostringstream ws;
+            ws << L"  Проверка: ||Ax-b|| = " << vr.residualNorm << L", обратная ошибка = " << vr.backwardError
+               << L" (порог " << verifyTol << L") — " << (failed ? L"НЕ ПРОЙДЕНА" : L"пройдена");
+            logToFile(ws.str());
+            logToFile(L"  Время проверки: " + to_wstring((long long)(verifyTime * 1000)) + L" мс");
+            logToFile(L"==============================================");
+        }
     }
 
     // Очистка памяти
-    for (int i = 0; i < N; i++) delete[] ALocal[i];
+    delete[] X;
     delete[] ALocal;
-    delete[] myColumns;
-    delete[] B;
-    if (rank == 0) for (int i = 0; i < N; i++) delete[] A[i];
-    delete[] A;
 
+    MPI_Comm_free(&g.rowComm);
+    MPI_Comm_free(&g.colComm);
     MPI_Finalize();
-    return 0;
+    return failed ? 3 : 0;
 }
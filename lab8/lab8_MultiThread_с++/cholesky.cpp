@@ -0,0 +1,181 @@
+#include "cholesky.h"
+#include <pthread.h>
+#include <atomic>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+// Правостороннее блочное разложение по столбцам блоков K:
+//   1) диагональный блок раскладывается одним потоком;
+//   2) блоки под ним решаются L(I,K) = A(I,K) * L(K,K)^-T — по блокам I между потоками;
+//   3) хвост A(I,J) -= L(I,K) * L(J,K)^T для K < J <= I — по парам (I,J) между потоками.
+// Фазы разделены барьером, задачи внутри фазы раздаются атомарным счётчиком.
+
+struct CholeskyShared {
+    double* A;
+    int n;
+    int nb;
+    int T;
+    int threads;
+    pthread_barrier_t barrier;
+    std::atomic<int> nextSolve;
+    std::atomic<int> nextUpdate;
+    int failedRow;
+};
+
+struct CholeskyTask {
+    CholeskyShared* s;
+    int id;
+};
+
+static void FactorDiagonal(CholeskyShared* s, int K)
+{
+    const int n = s->n;
+    int k0 = K * s->nb, k1 = std::min(k0 + s->nb, n);
+    double* A = s->A;
+    for (int c = k0; c < k1; ++c) {
+        double* rowC = A + (size_t)c * n;
+        double d = rowC[c];
+        for (int p = k0; p < c; ++p) d -= rowC[p] * rowC[p];
+        if (!(d > 0.0)) {
+            s->failedRow = c;
+            return;
+        }
+        double l = std::sqrt(d);
+        rowC[c] = l;
+        for (int r = c + 1; r < k1; ++r) {
+            double* rowR = A + (size_t)r * n;
+            double v = rowR[c];
+            for (int p = k0; p < c; ++p) v -= rowR[p] * rowC[p];
+            rowR[c] = v / l;
+        }
+    }
+}
+
+static void SolveBlock(CholeskyShared* s, int I, int K)
+{
+    const int n = s->n;
+    int k0 = K * s->nb, k1 = std::min(k0 + s->nb, n);
+    int i0 = I * s->nb, i1 = std::min(i0 + s->nb, n);
+    double* A = s->A;
+    for (int r = i0; r < i1; ++r) {
+        double* rowR = A + (size_t)r * n;
+        for (int c = k0; c < k1; ++c) {
+            const double* rowC = A + (size_t)c * n;
+            double v = rowR[c];
+            for (int p = k0; p < c; ++p) v -= rowR[p] * rowC[p];
+            rowR[c] = v / rowC[c];
+        }
+    }
+}
+
+static void UpdateBlock(CholeskyShared* s, int I, int J, int K)
+{
+    const int n = s->n;
+    int k0 = K * s->nb, k1 = std::min(k0 + s->nb, n);
+    int i0 = I * s->nb, i1 = std::min(i0 + s->nb, n);
+    int j0 = J * s->nb, j1 = std::min(j0 + s->nb, n);
+    double* A = s->A;
+    for (int r = i0; r < i1; ++r) {
+        double* rowR = A + (size_t)r * n;
+        const double* __restrict lr = rowR + k0;
+        int cEnd = (I == J) ? r + 1 : j1;
+        for (int c = j0; c < cEnd; ++c) {
+            const double* __restrict lc = A + (size_t)c * n + k0;
+            double dot = 0.0;
+            for (int p = 0; p < k1 - k0; ++p) dot += lr[p] * lc[p];
+            rowR[c] -= dot;
+        }
+    }
+}
+
+static void* CholeskyWorker(void* arg)
+{
+    CholeskyTask* t = (CholeskyTask*)arg;
+    CholeskyShared* s = t->s;
+    const int T = s->T;
+
+    for (int K = 0; K < T; ++K) {
+        if (t->id == 0) {
+            FactorDiagonal(s, K);
+            s->nextSolve = K + 1;
+            s->nextUpdate = 0;
+        }
+        pthread_barrier_wait(&s->barrier);
+        if (s->failedRow >= 0) break;
+
+        for (int I; (I = s->nextSolve.fetch_add(1)) < T;)
+            SolveBlock(s, I, K);
+        pthread_barrier_wait(&s->barrier);
+
+        // пары хвоста по строкам блоков: (K+1,K+1), (K+2,K+1), (K+2,K+2), ...
+        int r = T - K - 1;
+        int pairs = r * (r + 1) / 2;
+        for (int q; (q = s->nextUpdate.fetch_add(1)) < pairs;) {
+            int ii = (int)((std::sqrt(8.0 * q + 1.0) - 1.0) / 2.0);
+            while (ii * (ii + 1) / 2 > q) --ii;
+            while ((ii + 1) * (ii + 2) / 2 <= q) ++ii;
+            int jj = q - ii * (ii + 1) / 2;
+            UpdateBlock(s, K + 1 + ii, K + 1 + jj, K);
+        }
+        pthread_barrier_wait(&s->barrier);
+    }
+    return nullptr;
+}
+
+int CholeskyFactor(std::vector<double>& A, int n, int nb, int threads)
+{
+    if ((long long)A.size() != (long long)n * n) throw std::runtime_error("CholeskyFactor: size mismatch");
+    nb = std::max(1, nb);
+
+    CholeskyShared s;
+    s.A = A.data();
+    s.n = n;
+    s.nb = nb;
+    s.T = (n + nb - 1) / nb;
+    s.threads = std::max(1, threads);
+    s.failedRow = -1;
+    s.nextSolve = 0;
+    s.nextUpdate = 0;
+    pthread_barrier_init(&s.barrier, nullptr, s.threads);
+
+    std::vector<CholeskyTask> tasks(s.threads);
+    std::vector<pthread_t> ids(s.threads);
+    for (int t = 0; t < s.threads; ++t) tasks[t] = { &s, t };
+    for (int t = 1; t < s.threads; ++t)
+        if (pthread_create(&ids[t], nullptr, CholeskyWorker, &tasks[t]) != 0)
+            throw std::runtime_error("Ошибка при создании потока " + std::to_string(t));
+    CholeskyWorker(&tasks[0]);
+    for (int t = 1; t < s.threads; ++t)
+        pthread_join(ids[t], nullptr);
+    pthread_barrier_destroy(&s.barrier);
+
+    return s.failedRow;
+}
+
+void CholeskySolve(const std::vector<double>& L, int n, std::vector<double>& R, int m)
+{
+    // L * y = b по строкам L
+    for (int i = 0; i < n; ++i) {
+        const double* row = &L[(size_t)i * n];
+        double* ri = &R[(size_t)i * m];
+        for (int j = 0; j < i; ++j) {
+            if (row[j] == 0.0) continue;
+            const double* rj = &R[(size_t)j * m];
+            for (int t = 0; t < m; ++t) ri[t] -= row[j] * rj[t];
+        }
+        for (int t = 0; t < m; ++t) ri[t] /= row[i];
+    }
+    // L^T * x = y: строка i в L — это столбец i в L^T, вычитается сразу после нахождения x_i
+    for (int i = n - 1; i >= 0; --i) {
+        const double* row = &L[(size_t)i * n];
+        double* ri = &R[(size_t)i * m];
+        for (int t = 0; t < m; ++t) ri[t] /= row[i];
+        for (int j = 0; j < i; ++j) {
+            if (row[j] == 0.0) continue;
+            double* rj = &R[(size_t)j * m];
+            for (int t = 0; t < m; ++t) rj[t] -= row[j] * ri[t];
+        }
+    }
+}
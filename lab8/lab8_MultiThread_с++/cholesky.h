@@ -0,0 +1,11 @@
+#pragma once
+#include <vector>
+
+// Блочное разложение Холецкого A = L * L^T на месте: L пишется в нижний треугольник
+// (хранение по строкам n x n), верхний треугольник не трогается.
+// Возвращает -1 при успехе или номер строки, где ведущий элемент стал неположительным —
+// тогда A не положительно определена и нужно LU.
+int CholeskyFactor(std::vector<double>& A, int n, int nb, int threads);
+
+// Решение L * L^T * X = R для m правых частей; R (n x m по строкам) заменяется на X
+void CholeskySolve(const std::vector<double>& L, int n, std::vector<double>& R, int m);
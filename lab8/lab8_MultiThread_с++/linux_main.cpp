@@ -1,5 +1,5 @@
 #include <pthread.h>
-#include <unistd.h>   
+#include <unistd.h>
 #include <vector>
 #include <string>
 #include <fstream>
@@ -9,6 +9,21 @@
 #include <chrono>
 #include <cmath>
 #include <atomic>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+#include <cfloat>
+#include "lu_cache.h"
+#include "verify.h"
+#include "structured.h"
+#include "cholesky.h"
+
+// Способ раздачи строк потокам на каждом шаге k
+enum class DistMode {
+    Block,    // непрерывный диапазон startRow..endRow (исходный вариант)
+    Cyclic,   // блочно-циклически: блок b принадлежит потоку b % numThreads
+    Dynamic   // потоки забирают порции строк из атомарного счётчика
+};
 
 struct WorkerInfo {
     int id;
@@ -17,9 +32,18 @@ struct WorkerInfo {
 };
 
 static std::vector<double> Aflat;
-static std::vector<double> B;
+static std::vector<double> B;   // правые части по строкам: N x M
 static int N;
+static int M = 1;
 static int numThreads;
+static DistMode distMode = DistMode::Cyclic;
+static int blockSize = 8;
+static double loadMs = 0.0;   // чтение A.txt и B.txt, для строки TIMINGS
+static const int CHOLESKY_BLOCK = 64;
+
+// Смешанная точность: пул раскладывает float-копию вместо Aflat
+static bool factorFloat = false;
+static std::vector<float> Aflat32;
 
 static std::vector<WorkerInfo> workers;
 static std::vector<pthread_t> threads;
@@ -29,13 +53,13 @@ static pthread_cond_t cvStart = PTHREAD_COND_INITIALIZER;
 static pthread_cond_t cvDone  = PTHREAD_COND_INITIALIZER;
 
 static int current_k = -1;
-static std::vector<double> shared_pivotRow;
-static double shared_akk = 0.0;
-static double shared_bk = 0.0;
+static long stepId = 0;
+static std::atomic<int> nextRow(0);
 static int finishedCount = 0;
 static bool terminateFlag = false;
 
-void ReadMatrixAndVector(const std::string& folder, std::vector<double>& Af, std::vector<double>& Bv, int& n)
+// B.txt может содержать несколько правых частей — по m чисел в строке
+void ReadMatrixAndVector(const std::string& folder, std::vector<double>& Af, std::vector<double>& Bv, int& n, int& m)
 {
     std::ifstream finA(folder + "/A.txt");
     if (!finA) throw std::runtime_error("Cannot open A.txt");
@@ -60,27 +84,115 @@ void ReadMatrixAndVector(const std::string& folder, std::vector<double>& Af, std
 
     std::ifstream finB(folder + "/B.txt");
     if (!finB) throw std::runtime_error("Cannot open B.txt");
-    Bv.assign(n, 0.0);
-    for (int i = 0; i < n; ++i) {
-        if (!(finB >> Bv[i])) throw std::runtime_error("B.txt not match size");
+    m = 0;
+    Bv.clear();
+    while ((int)Bv.size() < n * std::max(m, 1) && std::getline(finB, line))
+    {
+        std::istringstream ss(line);
+        int count = 0;
+        double v;
+        while (ss >> v) { Bv.push_back(v); ++count; }
+        if (count == 0) continue;
+        if (m == 0) m = count;
+        else if (count != m) throw std::runtime_error("B.txt: inconsistent row size");
     }
+    if (m == 0 || (int)Bv.size() != n * m) throw std::runtime_error("B.txt not match size");
 }
 
-void WriteVector(const std::string& path, const std::vector<double>& X)
+void WriteVector(const std::string& path, const std::vector<double>& X, int m)
 {
     std::ofstream fout(path);
     fout << std::setprecision(17);
-    for (double v : X) fout << v << "\n";
+    for (size_t i = 0; i < X.size(); ++i)
+        fout << X[i] << ((i + 1) % m == 0 ? "\n" : " ");
+}
+
+DistMode ParseDistMode(const std::string& s)
+{
+    if (s == "block") return DistMode::Block;
+    if (s == "cyclic") return DistMode::Cyclic;
+    if (s == "dynamic") return DistMode::Dynamic;
+    throw std::runtime_error("Unknown --dist value: " + s);
+}
+
+const char* DistModeName(DistMode m)
+{
+    switch (m) {
+        case DistMode::Block: return "block";
+        case DistMode::Cyclic: return "cyclic";
+        case DistMode::Dynamic: return "dynamic";
+    }
+    return "?";
+}
+
+// Исключение строки i по ведущей строке k; ведущая строка на шаге k не меняется,
+// поэтому читается прямо из A без копирования. Множитель остаётся на месте a_ik,
+// правые части не трогаются — их решает SolveLU по готовому разложению.
+template <class T>
+static inline void EliminateRowT(T* A, int k, int i)
+{
+    size_t baseI = (size_t)i * N;
+    size_t baseK = (size_t)k * N;
+    T a_ik = A[baseI + k];
+    if (a_ik == 0) return;
+    T factor = a_ik / A[baseK + k];
+    A[baseI + k] = factor;
+
+    T* __restrict rowI = A + baseI;
+    const T* __restrict rowK = A + baseK;
+    for (int j = k + 1; j < N; ++j)
+        rowI[j] -= factor * rowK[j];
+}
+
+static inline void EliminateRow(int k, int i)
+{
+    if (factorFloat) EliminateRowT(Aflat32.data(), k, i);
+    else EliminateRowT(Aflat.data(), k, i);
+}
+
+static void ProcessStep(const WorkerInfo* wi, int k)
+{
+    switch (distMode) {
+        case DistMode::Block: {
+            int rowBegin = std::max(wi->startRow, k + 1);
+            for (int i = rowBegin; i < wi->endRow; ++i)
+                EliminateRow(k, i);
+            break;
+        }
+        case DistMode::Cyclic: {
+            // первый свой блок, в котором есть строки ниже k
+            int b0 = (k + 1) / blockSize;
+            int b = b0 + ((wi->id - b0 % numThreads) + numThreads) % numThreads;
+            for (; b * blockSize < N; b += numThreads) {
+                int rowBegin = std::max(b * blockSize, k + 1);
+                int rowEnd = std::min((b + 1) * blockSize, N);
+                for (int i = rowBegin; i < rowEnd; ++i)
+                    EliminateRow(k, i);
+            }
+            break;
+        }
+        case DistMode::Dynamic: {
+            while (true) {
+                int rowBegin = nextRow.fetch_add(blockSize, std::memory_order_relaxed);
+                if (rowBegin >= N) break;
+                int rowEnd = std::min(rowBegin + blockSize, N);
+                for (int i = rowBegin; i < rowEnd; ++i)
+                    EliminateRow(k, i);
+            }
+            break;
+        }
+    }
 }
 
 void* WorkerRoutine(void* arg)
 {
     WorkerInfo* wi = (WorkerInfo*)arg;
+    long seenStep = 0;
 
     while (true)
     {
         pthread_mutex_lock(&mutex_shared);
-        while (current_k == -1 && !terminateFlag) {
+        while (stepId == seenStep && !terminateFlag) {
             pthread_cond_wait(&cvStart, &mutex_shared);
         }
 
@@ -89,29 +201,11 @@ void* WorkerRoutine(void* arg)
             break;
         }
 
+        seenStep = stepId;
         int k = current_k;
-        double akk = shared_akk;
-        double bk = shared_bk;
-        std::vector<double> localPivot = shared_pivotRow;
         pthread_mutex_unlock(&mutex_shared);
 
-        int rowBegin = std::max(wi->startRow, k + 1);
-        int rowEnd = wi->endRow;
-        if (rowBegin < rowEnd) {
-            int trailing = (int)localPivot.size();
-            for (int i = rowBegin; i < rowEnd; ++i) {
-                int baseI = i * N;
-                double a_ik = Aflat[baseI + k];
-                if (a_ik == 0.0) continue;
-                double factor = a_ik / akk;
-                Aflat[baseI + k] = factor;
-
-                int pj = k + 1;
-                for (int t = 0; t < trailing; ++t, ++pj)
-                    Aflat[baseI + pj] -= factor * localPivot[t];
-                B[i] -= factor * bk;
-            }
-        }
+        ProcessStep(wi, k);
 
         pthread_mutex_lock(&mutex_shared);
         ++finishedCount;
@@ -124,19 +218,9 @@ void* WorkerRoutine(void* arg)
     return nullptr;
 }
 
-int main(int argc, char* argv[])
+// Прямой ход на пуле потоков: Aflat раскладывается на месте в L и U
+void RunElimination()
 {
-    if (argc < 2) {
-        std::cerr << "Ожидался аргумент — путь к папке с данными\n";
-        return 1;
-    }
-    std::string folder = argv[1];
-
-    numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
-    if (numThreads <= 0) numThreads = 1;
-
-    ReadMatrixAndVector(folder, Aflat, B, N);
-
     workers.resize(numThreads);
     threads.resize(numThreads);
     int rowsPer = (N + numThreads - 1) / numThreads;
@@ -144,42 +228,30 @@ int main(int argc, char* argv[])
         int s = t * rowsPer;
         int e = std::min((t + 1) * rowsPer, N);
         workers[t].id = t;
-        workers[t].startRow = s;
+        workers[t].startRow = std::min(s, N);
         workers[t].endRow = e;
     }
 
+    terminateFlag = false;
+    stepId = 0;
+    current_k = -1;
+
     for (int t = 0; t < numThreads; ++t) {
-        if (pthread_create(&threads[t], nullptr, WorkerRoutine, &workers[t]) != 0) {
-            std::cerr << "Ошибка при создании потока " << t << "\n";
-            return 2;
-        }
+        if (pthread_create(&threads[t], nullptr, WorkerRoutine, &workers[t]) != 0)
+            throw std::runtime_error("Ошибка при создании потока " + std::to_string(t));
     }
 
-    auto t1 = std::chrono::high_resolution_clock::now();
-
-    for (int k = 0; k < N; ++k) {
-        int pivotIndex = k * N + k;
-        double akk = Aflat[pivotIndex];
-
-        int trailing = N - (k + 1);
-        std::vector<double> pivotRow(trailing);
-        for (int j = 0; j < trailing; ++j)
-            pivotRow[j] = Aflat[k * N + (k + 1 + j)];
-        double bk = B[k];
-
+    for (int k = 0; k < N - 1; ++k) {
         pthread_mutex_lock(&mutex_shared);
-        shared_pivotRow = std::move(pivotRow); 
-        shared_akk = akk;
-        shared_bk = bk;
+        nextRow.store(k + 1, std::memory_order_relaxed);
         finishedCount = 0;
         current_k = k;
+        ++stepId;
         pthread_cond_broadcast(&cvStart);
-        
+
         while (finishedCount < numThreads) {
             pthread_cond_wait(&cvDone, &mutex_shared);
         }
-        
-        current_k = -1;
         pthread_mutex_unlock(&mutex_shared);
     }
 
@@ -191,27 +263,427 @@ int main(int argc, char* argv[])
     for (int t = 0; t < numThreads; ++t) {
         pthread_join(threads[t], nullptr);
     }
+}
+
+struct RefineResult {
+    bool converged = false;
+    int iterations = 0;
+    double backwardError = 0.0;
+};
+
+// Разложение float-копии A и итерационное уточнение с невязкой в double.
+// Aflat остаётся нетронутой; при застое уточнения converged = false.
+RefineResult SolveMixed(std::vector<double>& X, int maxIter)
+{
+    RefineResult res;
+
+    Aflat32.assign(Aflat.begin(), Aflat.end());
+    factorFloat = true;
+    RunElimination();
+    factorFloat = false;
+    for (int i = 0; i < N; ++i) {
+        float d = Aflat32[(size_t)i * N + i];
+        if (!std::isfinite(d) || d == 0.0f) return res;
+    }
+
+    // останов как в LAPACK dsgesv: обратная ошибка на уровне eps * sqrt(N)
+    const double tol = DBL_EPSILON * std::sqrt((double)N);
+    X = B;
+    SolveLU(Aflat32, N, X, M, numThreads);
+
+    std::vector<double> R;
+    double prev = HUGE_VAL;
+    for (int it = 0; it <= maxIter; ++it) {
+        double berr = VerifySolution(Aflat, N, B, X, M, numThreads, &R).backwardError;
+        res.iterations = it;
+        res.backwardError = berr;
+        if (!std::isfinite(berr)) return res;
+        if (berr <= tol) {
+            res.converged = true;
+            return res;
+        }
+        if (berr > 0.5 * prev) return res;   // уточнение почти не сходится
+        prev = berr;
+
+        SolveLU(Aflat32, N, R, M, numThreads);
+        for (size_t t = 0; t < X.size(); ++t) X[t] += R[t];
+    }
+    return res;
+}
 
-    std::vector<double> X(N);
-    for (int i = N - 1; i >= 0; --i) {
-        double sum = B[i];
-        int baseI = i * N;
-        for (int j = i + 1; j < N; ++j)
-            sum -= Aflat[baseI + j] * X[j];
-        double diag = Aflat[baseI + i];
-        X[i] = (std::abs(diag) < 1e-18) ? 0.0 : sum / diag;
+// Случайная система с диагональным преобладанием для замеров
+void GenerateSystem(int n, unsigned seed)
+{
+    N = n;
+    Aflat.assign((size_t)n * n, 0.0);
+    B.assign(n, 0.0);
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) Aflat[(size_t)i * n + j] = dist(rng);
+        Aflat[(size_t)i * n + i] = n + 1.0;
+        B[i] = dist(rng);
     }
+}
+
+std::vector<int> ParseIntList(const std::string& s)
+{
+    std::vector<int> res;
+    std::istringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty()) res.push_back(std::stoi(item));
+    return res;
+}
+
+// Эффективность E = T1 / (p * Tp) для каждого способа раздачи строк
+void RunBenchmark(const std::vector<int>& sizes, std::vector<int> threadCounts)
+{
+    int hw = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (hw <= 0) hw = 1;
+    if (threadCounts.empty()) {
+        for (int p = 1; p < hw; p *= 2) threadCounts.push_back(p);
+        threadCounts.push_back(hw);
+    }
+
+    const DistMode modes[] = { DistMode::Block, DistMode::Cyclic, DistMode::Dynamic };
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "N\tdist\tthreads\ttime_ms\tspeedup\tefficiency\n";
+    for (int n : sizes) {
+        GenerateSystem(n, 42);
+        numThreads = 1;
+        auto s1 = std::chrono::high_resolution_clock::now();
+        RunElimination();
+        auto s2 = std::chrono::high_resolution_clock::now();
+        double t1 = std::chrono::duration<double, std::milli>(s2 - s1).count();
+
+        for (DistMode m : modes) {
+            distMode = m;
+            for (int p : threadCounts) {
+                GenerateSystem(n, 42);
+                numThreads = p;
+                auto a = std::chrono::high_resolution_clock::now();
+                RunElimination();
+                auto b = std::chrono::high_resolution_clock::now();
+                double tp = std::chrono::duration<double, std::milli>(b - a).count();
+                std::cout << n << "\t" << DistModeName(m) << "\t" << p << "\t"
+                          << tp << "\t" << t1 / tp << "\t" << t1 / (p * tp) << "\n";
+            }
+        }
+    }
+}
+
+// Строка для lab8_Bench_с++: одна на запуск, времена в мс
+void PrintTimings(const char* engine, double factorMs, double solveMs, double writeMs)
+{
+    std::cout << "TIMINGS engine=" << engine << " n=" << N << " threads=" << numThreads << " procs=1"
+              << " load_ms=" << loadMs << " factor_ms=" << factorMs << " solve_ms=" << solveMs
+              << " write_ms=" << writeMs << "\n";
+}
 
+// Проверка решения по нетронутой копии A; код возврата 3, если порог превышен
+int ReportVerify(const std::vector<double>& A, const std::vector<double>& X, double tol)
+{
+    auto v1 = std::chrono::high_resolution_clock::now();
+    VerifyResult vr = VerifySolution(A, N, B, X, M, numThreads);
+    auto v2 = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> verifyTime = v2 - v1;
+
+    bool ok = vr.backwardError <= tol;
+    std::cout << "Проверка: ||Ax-b|| = " << vr.residualNorm
+              << ", обратная ошибка = " << vr.backwardError
+              << " (порог " << tol << ") — " << (ok ? "пройдена" : "НЕ ПРОЙДЕНА") << "\n";
+    std::cout << "Время проверки: " << verifyTime.count() << " мс\n";
+    std::cout << "==============================================\n";
+    return ok ? 0 : 3;
+}
+
+// Режим смешанной точности; при застое уточнения — обычное разложение в double
+int RunMixed(const std::string& folder, bool compare, bool verify, double verifyTol)
+{
+    std::vector<double> pristine;
+    if (compare || verify) pristine = Aflat;
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    std::vector<double> X;
+    RefineResult rr = SolveMixed(X, 10);
+    if (!rr.converged) {
+        RunElimination();
+        LUFactors lu;
+        lu.n = N;
+        lu.lu = std::move(Aflat);
+        X = B;
+        SolveLU(lu, X, M, numThreads);
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> mixedTime = t2 - t1;
+
+    WriteVector(folder + "/X.txt", X, M);
+    std::chrono::duration<double, std::milli> writeTime = std::chrono::high_resolution_clock::now() - t2;
+
+    double doubleMs = 0.0;
+    if (compare) {
+        Aflat = pristine;
+        auto d1 = std::chrono::high_resolution_clock::now();
+        RunElimination();
+        LUFactors lu;
+        lu.n = N;
+        lu.lu = std::move(Aflat);
+        std::vector<double> Xd = B;
+        SolveLU(lu, Xd, M, numThreads);
+        auto d2 = std::chrono::high_resolution_clock::now();
+        doubleMs = std::chrono::duration<double, std::milli>(d2 - d1).count();
+    }
+
+    std::cout << "==============================================\n";
+    std::cout << "Размер матрицы: " << N << "x" << N << "\n";
+    std::cout << "Потоков: " << numThreads << "\n";
+    std::cout << "Смешанная точность: " << (rr.converged ? "сошлось" : "застой, пересчёт в double") << "\n";
+    std::cout << "Итераций уточнения: " << rr.iterations << "\n";
+    std::cout << "Обратная ошибка: " << rr.backwardError << "\n";
+    std::cout << "Время: " << mixedTime.count() << " мс\n";
+    if (compare) {
+        std::cout << "Время double: " << doubleMs << " мс\n";
+        std::cout << "Ускорение: " << doubleMs / mixedTime.count() << "\n";
+    }
+    std::cout << "==============================================\n";
+    PrintTimings("mixed", mixedTime.count(), 0.0, writeTime.count());
+    return verify ? ReportVerify(pristine, X, verifyTol) : 0;
+}
+
+// Холецкий пишет L в нижний треугольник Aflat; A восстанавливается из верхнего
+// треугольника и сохранённой диагонали
+static void RestoreSymmetric(const std::vector<double>& diag)
+{
+    for (int i = 0; i < N; ++i) {
+        double* row = &Aflat[(size_t)i * N];
+        for (int j = 0; j < i; ++j) row[j] = Aflat[(size_t)j * N + i];
+        row[i] = diag[i];
+    }
+}
+
+// Ленточные, разреженные и SPD-системы решаются своими путями; с --compare та же система
+// решается и плотным движком, чтобы сравнить время и результат.
+// -1 — разложение Холецкого сорвалось, Aflat восстановлена и систему надо решать LU.
+int RunStructured(const std::string& folder, SolverPath path, const MatrixStructure& ms, double analyzeMs,
+                  bool compare, bool verify, double verifyTol)
+{
+    auto t1 = std::chrono::high_resolution_clock::now();
+    std::vector<double> X = B;
+    long long fill = 0;
+    try {
+        switch (path) {
+            case SolverPath::Cholesky: {
+                std::vector<double> diag(N);
+                for (int i = 0; i < N; ++i) diag[i] = Aflat[(size_t)i * N + i];
+                int bad = CholeskyFactor(Aflat, N, CHOLESKY_BLOCK, numThreads);
+                if (bad < 0) CholeskySolve(Aflat, N, X, M);
+                if (bad >= 0 || compare || verify) RestoreSymmetric(diag);
+                if (bad >= 0) {
+                    std::chrono::duration<double, std::milli> lost = std::chrono::high_resolution_clock::now() - t1;
+                    std::cout << "Холецкий: неположительный ведущий элемент в строке " << bad
+                              << " (" << lost.count() << " мс), переход на LU\n";
+                    return -1;
+                }
+                break;
+            }
+            case SolverPath::Tridiagonal: SolveTridiagonal(Aflat, N, X, M); break;
+            case SolverPath::Banded: SolveBanded(Aflat, N, ms.lower, ms.upper, X, M); break;
+            case SolverPath::Sparse: SolveSparse(Aflat, N, X, M, &fill); break;
+            case SolverPath::Dense: break;
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 2;
+    }
     auto t2 = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double, std::milli> elapsed = t2 - t1;
 
-    WriteVector(folder + "/X.txt", X);
+    WriteVector(folder + "/X.txt", X, M);
+    std::chrono::duration<double, std::milli> writeTime = std::chrono::high_resolution_clock::now() - t2;
+
+    // специальные пути Aflat не трогают, плотному движку нужна копия только ради --verify
+    double denseMs = 0.0, maxDiff = 0.0;
+    if (compare) {
+        std::vector<double> saved;
+        if (verify) saved = Aflat;
+        auto d1 = std::chrono::high_resolution_clock::now();
+        RunElimination();
+        LUFactors lu;
+        lu.n = N;
+        lu.lu = std::move(Aflat);
+        std::vector<double> Xd = B;
+        SolveLU(lu, Xd, M, numThreads);
+        auto d2 = std::chrono::high_resolution_clock::now();
+        denseMs = std::chrono::duration<double, std::milli>(d2 - d1).count();
+        for (size_t t = 0; t < X.size(); ++t) maxDiff = std::max(maxDiff, std::abs(X[t] - Xd[t]));
+        Aflat.swap(saved);
+    }
+
+    std::cout << "==============================================\n";
+    std::cout << "Размер матрицы: " << N << "x" << N << "\n";
+    std::cout << "Структура: плотность " << ms.density * 100 << "%, лента " << ms.lower << "/" << ms.upper
+              << " (анализ " << analyzeMs << " мс)\n";
+    std::cout << "Путь: " << SolverPathName(path);
+    if (path == SolverPath::Cholesky) std::cout << " (блок " << CHOLESKY_BLOCK << ", потоков " << numThreads << ")";
+    std::cout << "\n";
+    if (path == SolverPath::Sparse)
+        std::cout << "Ненулевых в A: " << ms.nnz << ", в L+U: " << fill << "\n";
+    std::cout << "Правых частей: " << M << "\n";
+    std::cout << "Время: " << elapsed.count() << " мс\n";
+    if (compare) {
+        std::cout << "Время dense (" << numThreads << " потоков): " << denseMs << " мс\n";
+        std::cout << "Ускорение: " << denseMs / elapsed.count() << "\n";
+        std::cout << "max|X - Xdense| = " << maxDiff << "\n";
+    }
+    std::cout << "==============================================\n";
+    // у специальных путей разложение и подстановки не разделяются
+    PrintTimings(SolverPathName(path), elapsed.count(), 0.0, writeTime.count());
+    return verify ? ReportVerify(Aflat, X, verifyTol) : 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cerr << "Ожидался аргумент — путь к папке с данными\n";
+        std::cerr << "Использование: linux_main <папка> [--threads=T] [--dist=block|cyclic|dynamic] [--block=B] [--cache=DIR] [--mixed] [--dense] [--compare] [--verify[=TOL]]\n";
+        std::cerr << "               linux_main --bench [--sizes=1000,2000] [--threads=1,2,4] [--block=B]\n";
+        return 1;
+    }
+
+    std::string folder;
+    std::string cacheDir;
+    bool bench = false;
+    bool mixed = false;
+    bool compare = false;
+    bool forceDense = false;
+    bool verify = false;
+    double verifyTol = 1e-10;
+    std::vector<int> sizes = { 1000, 2000, 4000, 8000 };
+    std::vector<int> threadCounts;
+
+    try {
+        for (int a = 1; a < argc; ++a) {
+            std::string arg = argv[a];
+            if (arg == "--bench") bench = true;
+            else if (arg.rfind("--threads=", 0) == 0) threadCounts = ParseIntList(arg.substr(10));
+            else if (arg.rfind("--dist=", 0) == 0) distMode = ParseDistMode(arg.substr(7));
+            else if (arg.rfind("--block=", 0) == 0) blockSize = std::stoi(arg.substr(8));
+            else if (arg.rfind("--sizes=", 0) == 0) sizes = ParseIntList(arg.substr(8));
+            else if (arg.rfind("--cache=", 0) == 0) cacheDir = arg.substr(8);
+            else if (arg == "--mixed") mixed = true;
+            else if (arg == "--compare") compare = true;
+            else if (arg == "--dense") forceDense = true;
+            else if (arg == "--verify") verify = true;
+            else if (arg.rfind("--verify=", 0) == 0) { verify = true; verifyTol = std::stod(arg.substr(9)); }
+            else folder = arg;
+        }
+        if (blockSize <= 0) throw std::runtime_error("--block must be positive");
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    if (bench) {
+        RunBenchmark(sizes, threadCounts);
+        return 0;
+    }
+
+    if (!threadCounts.empty()) numThreads = threadCounts[0];
+    else numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (numThreads <= 0) numThreads = 1;
+
+    auto l1 = std::chrono::high_resolution_clock::now();
+    ReadMatrixAndVector(folder, Aflat, B, N, M);
+    loadMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - l1).count();
+
+    // По плотности и ширине ленты выбирается решатель; --dense оставляет плотный движок
+    auto a1 = std::chrono::high_resolution_clock::now();
+    MatrixStructure ms = AnalyzeStructure(Aflat, N);
+    SolverPath path = forceDense ? SolverPath::Dense : ChoosePath(ms, N);
+    auto a2 = std::chrono::high_resolution_clock::now();
+    double analyzeMs = std::chrono::duration<double, std::milli>(a2 - a1).count();
+
+    if (!mixed && path != SolverPath::Dense) {
+        int rc = RunStructured(folder, path, ms, analyzeMs, compare, verify, verifyTol);
+        if (rc >= 0) return rc;
+    }
+
+    if (mixed) return RunMixed(folder, compare, verify, verifyTol);
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    // Разложение берётся из кэша, если A уже раскладывалась
+    LUFactors lu;
+    bool cacheHit = false;
+    std::string cachePath;
+    if (!cacheDir.empty()) {
+        uint64_t hash = HashMatrix(Aflat, N);
+        cachePath = CachePath(cacheDir, hash);
+        cacheHit = LoadLU(cachePath, hash, N, lu);
+        lu.hash = hash;
+    }
+
+    std::vector<double> pristine;
+    if (verify) {
+        if (cacheHit) pristine.swap(Aflat);
+        else pristine = Aflat;
+    }
+
+    try {
+        if (!cacheHit) {
+            RunElimination();
+            lu.n = N;
+            lu.lu = std::move(Aflat);
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 2;
+    }
+
+    // кэш — только ускорение: если сохранить не удалось, решение всё равно доводится до X.txt
+    bool cacheSaved = false;
+    if (!cacheHit && !cachePath.empty()) {
+        try {
+            SaveLU(cachePath, lu);
+            cacheSaved = true;
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Кэш LU не сохранён: " << e.what() << "\n";
+        }
+    }
+
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    std::vector<double> X = B;
+    SolveLU(lu, X, M, numThreads);
+
+    auto t3 = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> factorTime = t2 - t1;
+    std::chrono::duration<double, std::milli> solveTime = t3 - t2;
+    std::chrono::duration<double, std::milli> elapsed = t3 - t1;
+
+    WriteVector(folder + "/X.txt", X, M);
+    std::chrono::duration<double, std::milli> writeTime = std::chrono::high_resolution_clock::now() - t3;
 
     std::cout << "==============================================\n";
     std::cout << "Размер матрицы: " << N << "x" << N << "\n";
     std::cout << "Потоков: " << numThreads << "\n";
+    std::cout << "Распределение: " << DistModeName(distMode) << " (блок " << blockSize << ")\n";
+    std::cout << "Структура: плотность " << ms.density * 100 << "%, лента " << ms.lower << "/" << ms.upper
+              << " (анализ " << analyzeMs << " мс)\n";
+    std::cout << "Правых частей: " << M << "\n";
+    if (!cacheDir.empty())
+        std::cout << "Кэш LU: " << (cacheHit ? "попадание" : cacheSaved ? "промах, сохранено" : "промах, не сохранено") << " (" << cachePath << ")\n";
+    std::cout << "Разложение: " << factorTime.count() << " мс\n";
+    std::cout << "Подстановки: " << solveTime.count() << " мс\n";
     std::cout << "Время: " << elapsed.count() << " мс\n";
     std::cout << "==============================================\n";
+    PrintTimings("dense", factorTime.count(), solveTime.count(), writeTime.count());
 
-    return 0;
+    return verify ? ReportVerify(pristine, X, verifyTol) : 0;
 }
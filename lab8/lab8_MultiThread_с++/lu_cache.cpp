@@ -0,0 +1,343 @@
+#include "lu_cache.h"
+#include <pthread.h>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+static const char LU_MAGIC[8] = { 'L', 'A', 'B', '8', 'L', 'U', '1', '\0' };
+static const int SOLVE_BLOCK = 64;
+
+uint64_t HashMatrix(const std::vector<double>& A, int n)
+{
+    uint64_t h = 1469598103934665603ULL;
+    auto mix = [&h](const void* data, size_t bytes) {
+        const unsigned char* p = (const unsigned char*)data;
+        for (size_t i = 0; i < bytes; ++i) {
+            h ^= p[i];
+            h *= 1099511628211ULL;
+        }
+    };
+    mix(&n, sizeof(n));
+    mix(A.data(), (size_t)n * n * sizeof(double));
+    return h;
+}
+
+std::string CachePath(const std::string& dir, uint64_t hash)
+{
+    std::ostringstream ss;
+    ss << dir << "/lu_" << std::hex << std::setw(16) << std::setfill('0') << hash << ".bin";
+    return ss.str();
+}
+
+bool LoadLU(const std::string& path, uint64_t hash, int n, LUFactors& f)
+{
+    std::ifstream fin(path, std::ios::binary);
+    if (!fin) return false;
+
+    char magic[8];
+    long long fileN = 0;
+    uint64_t fileHash = 0;
+    fin.read(magic, sizeof(magic));
+    fin.read((char*)&fileN, sizeof(fileN));
+    fin.read((char*)&fileHash, sizeof(fileHash));
+    if (!fin || std::memcmp(magic, LU_MAGIC, sizeof(magic)) != 0) return false;
+    if (fileN != n || fileHash != hash) return false;
+
+    f.n = n;
+    f.hash = hash;
+    f.lu.resize((size_t)n * n);
+    fin.read((char*)f.lu.data(), f.lu.size() * sizeof(double));
+    return (bool)fin;
+}
+
+void SaveLU(const std::string& path, const LUFactors& f)
+{
+    // пишем во временный файл и переименовываем, чтобы параллельный запуск не прочитал половину
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream fout(tmp, std::ios::binary | std::ios::trunc);
+        if (!fout) throw std::runtime_error("Cannot create " + tmp);
+        long long n = f.n;
+        fout.write(LU_MAGIC, sizeof(LU_MAGIC));
+        fout.write((const char*)&n, sizeof(n));
+        fout.write((const char*)&f.hash, sizeof(f.hash));
+        fout.write((const char*)f.lu.data(), f.lu.size() * sizeof(double));
+        if (!fout.flush()) {
+            fout.close();
+            std::remove(tmp.c_str());
+            throw std::runtime_error("Cannot write " + tmp);
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("Cannot rename " + tmp);
+    }
+}
+
+template <class T>
+struct SolveTask {
+    const T* lu;
+    int n;
+    double* R;
+    int m;
+    int c0;
+    int c1;
+};
+
+// x_i[c0..c1) -= a * x_j[c0..c1)
+static inline void Axpy(double* xi, const double* xj, double a, int c0, int c1)
+{
+    for (int c = c0; c < c1; ++c) xi[c] -= a * xj[c];
+}
+
+template <class T>
+static void* SolveColumns(void* arg)
+{
+    SolveTask<T>* t = (SolveTask<T>*)arg;
+    const int n = t->n;
+    const int m = t->m;
+    const T* lu = t->lu;
+    double* R = t->R;
+
+    // Прямой ход по L: сначала вклад уже решённых блоков, затем диагональный блок
+    for (int I0 = 0; I0 < n; I0 += SOLVE_BLOCK) {
+        int I1 = std::min(I0 + SOLVE_BLOCK, n);
+        for (int J0 = 0; J0 < I0; J0 += SOLVE_BLOCK) {
+            int J1 = J0 + SOLVE_BLOCK;
+            for (int i = I0; i < I1; ++i) {
+                const T* row = lu + (size_t)i * n;
+                for (int j = J0; j < J1; ++j)
+                    if (row[j] != 0) Axpy(R + (size_t)i * m, R + (size_t)j * m, row[j], t->c0, t->c1);
+            }
+        }
+        for (int i = I0; i < I1; ++i) {
+            const T* row = lu + (size_t)i * n;
+            for (int j = I0; j < i; ++j)
+                if (row[j] != 0) Axpy(R + (size_t)i * m, R + (size_t)j * m, row[j], t->c0, t->c1);
+        }
+    }
+
+    // Обратный ход по U снизу вверх
+    for (int I1 = n; I1 > 0; I1 -= SOLVE_BLOCK) {
+        int I0 = std::max(I1 - SOLVE_BLOCK, 0);
+        for (int J0 = I1; J0 < n; J0 += SOLVE_BLOCK) {
+            int J1 = std::min(J0 + SOLVE_BLOCK, n);
+            for (int i = I0; i < I1; ++i) {
+                const T* row = lu + (size_t)i * n;
+                for (int j = J0; j < J1; ++j)
+                    if (row[j] != 0) Axpy(R + (size_t)i * m, R + (size_t)j * m, row[j], t->c0, t->c1);
+            }
+        }
+        for (int i = I1 - 1; i >= I0; --i) {
+            const T* row = lu + (size_t)i * n;
+            double* xi = R + (size_t)i * m;
+            for (int j = i + 1; j < I1; ++j)
+                if (row[j] != 0) Axpy(xi, R + (size_t)j * m, row[j], t->c0, t->c1);
+            double diag = row[i];
+            for (int c = t->c0; c < t->c1; ++c)
+                xi[c] = (std::abs(diag) < 1e-18) ? 0.0 : xi[c] / diag;
+        }
+    }
+    return nullptr;
+}
+
+#if defined(__GNUC__)
+typedef double v4d __attribute__((vector_size(4 * sizeof(double))));
+
+// Скалярное произведение на векторных регистрах: две независимые суммы по 4 числа
+static inline double Dot(const double* a, const double* x, int len)
+{
+    v4d s0 = { 0.0, 0.0, 0.0, 0.0 }, s1 = s0;
+    int j = 0;
+    for (; j + 8 <= len; j += 8) {
+        v4d a0, a1, x0, x1;
+        std::memcpy(&a0, a + j, sizeof(v4d));
+        std::memcpy(&a1, a + j + 4, sizeof(v4d));
+        std::memcpy(&x0, x + j, sizeof(v4d));
+        std::memcpy(&x1, x + j + 4, sizeof(v4d));
+        s0 += a0 * x0;
+        s1 += a1 * x1;
+    }
+    v4d s = s0 + s1;
+    double r = (s[0] + s[1]) + (s[2] + s[3]);
+    for (; j < len; ++j) r += a[j] * x[j];
+    return r;
+}
+#endif
+
+// Общий вариант (и для float-разложения): четыре независимые суммы
+template <class T>
+static inline double Dot(const T* a, const double* x, int len)
+{
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    int j = 0;
+    for (; j + 4 <= len; j += 4) {
+        s0 += a[j] * x[j];
+        s1 += a[j + 1] * x[j + 1];
+        s2 += a[j + 2] * x[j + 2];
+        s3 += a[j + 3] * x[j + 3];
+    }
+    for (; j < len; ++j) s0 += a[j] * x[j];
+    return (s0 + s1) + (s2 + s3);
+}
+
+template <class T>
+struct RowSolveShared {
+    const T* lu;
+    int n;
+    double* R;
+    int m;
+    int threads;
+    pthread_barrier_t barrier;
+    // потоки ждут, пока запустятся все: до этого неизвестно, сколько их на самом деле
+    pthread_mutex_t gate;
+    pthread_cond_t opened;
+    bool ready;
+};
+
+template <class T>
+struct RowSolveTask {
+    RowSolveShared<T>* s;
+    int id;
+};
+
+// x_i -= L(i, j0..j1) * x(j0..j1) для одной строки
+template <class T>
+static inline void RowUpdate(const T* row, double* R, int m, int i, int j0, int j1)
+{
+    if (m == 1) {
+        R[i] -= Dot(row + j0, R + j0, j1 - j0);
+        return;
+    }
+    for (int j = j0; j < j1; ++j)
+        if (row[j] != 0) Axpy(R + (size_t)i * m, R + (size_t)j * m, row[j], 0, m);
+}
+
+// Правых частей меньше, чем потоков: блок строк делится между потоками.
+// Вклад уже решённых блоков считается параллельно (по строкам блока),
+// диагональный блок решает поток 0; шаги разделены барьером.
+template <class T>
+static void* SolveRows(void* arg)
+{
+    RowSolveTask<T>* t = (RowSolveTask<T>*)arg;
+    RowSolveShared<T>* s = t->s;
+    const int n = s->n;
+    const int m = s->m;
+    const T* lu = s->lu;
+    double* R = s->R;
+
+    pthread_mutex_lock(&s->gate);
+    while (!s->ready) pthread_cond_wait(&s->opened, &s->gate);
+    pthread_mutex_unlock(&s->gate);
+
+    auto myRows = [&](int I0, int I1, int& r0, int& r1) {
+        int per = (I1 - I0 + s->threads - 1) / s->threads;
+        r0 = std::min(I0 + t->id * per, I1);
+        r1 = std::min(r0 + per, I1);
+    };
+
+    for (int I0 = 0; I0 < n; I0 += SOLVE_BLOCK) {
+        int I1 = std::min(I0 + SOLVE_BLOCK, n), r0, r1;
+        myRows(I0, I1, r0, r1);
+        for (int i = r0; i < r1; ++i) RowUpdate(lu + (size_t)i * n, R, m, i, 0, I0);
+        pthread_barrier_wait(&s->barrier);
+        if (t->id == 0)
+            for (int i = I0; i < I1; ++i) RowUpdate(lu + (size_t)i * n, R, m, i, I0, i);
+        pthread_barrier_wait(&s->barrier);
+    }
+
+    for (int I1 = n; I1 > 0; I1 -= SOLVE_BLOCK) {
+        int I0 = std::max(I1 - SOLVE_BLOCK, 0), r0, r1;
+        myRows(I0, I1, r0, r1);
+        for (int i = r0; i < r1; ++i) RowUpdate(lu + (size_t)i * n, R, m, i, I1, n);
+        pthread_barrier_wait(&s->barrier);
+        if (t->id == 0) {
+            for (int i = I1 - 1; i >= I0; --i) {
+                const T* row = lu + (size_t)i * n;
+                RowUpdate(row, R, m, i, i + 1, I1);
+                double diag = row[i];
+                double* xi = R + (size_t)i * m;
+                for (int c = 0; c < m; ++c)
+                    xi[c] = (std::abs(diag) < 1e-18) ? 0.0 : xi[c] / diag;
+            }
+        }
+        pthread_barrier_wait(&s->barrier);
+    }
+    return nullptr;
+}
+
+template <class T>
+static void SolveRowsParallel(const T* lu, int n, std::vector<double>& R, int m, int threads)
+{
+    RowSolveShared<T> s;
+    s.lu = lu;
+    s.n = n;
+    s.R = R.data();
+    s.m = m;
+    s.ready = false;
+    pthread_mutex_init(&s.gate, nullptr);
+    pthread_cond_init(&s.opened, nullptr);
+
+    std::vector<RowSolveTask<T>> tasks(threads);
+    std::vector<pthread_t> ids(threads);
+    for (int t = 0; t < threads; ++t) tasks[t] = { &s, t };
+    // не создался поток — считаем теми, что уже запущены: они ещё ждут у ворот, и
+    // ни строки, ни барьер пока не распределены
+    int started = 1;
+    while (started < threads && pthread_create(&ids[started], nullptr, SolveRows<T>, &tasks[started]) == 0) ++started;
+    s.threads = started;
+    pthread_barrier_init(&s.barrier, nullptr, started);
+    pthread_mutex_lock(&s.gate);
+    s.ready = true;
+    pthread_cond_broadcast(&s.opened);
+    pthread_mutex_unlock(&s.gate);
+
+    SolveRows<T>(&tasks[0]);
+    for (int t = 1; t < started; ++t)
+        pthread_join(ids[t], nullptr);
+    pthread_barrier_destroy(&s.barrier);
+    pthread_cond_destroy(&s.opened);
+    pthread_mutex_destroy(&s.gate);
+}
+
+template <class T>
+static void SolveParallel(const T* lu, int n, std::vector<double>& R, int m, int threads)
+{
+    if ((int)R.size() != n * m) throw std::runtime_error("SolveLU: RHS size mismatch");
+    threads = std::max(1, threads);
+    if (m < threads && n >= 2 * SOLVE_BLOCK) {
+        SolveRowsParallel(lu, n, R, m, threads);
+        return;
+    }
+    threads = std::min(threads, m);
+
+    std::vector<SolveTask<T>> tasks(threads);
+    std::vector<pthread_t> ids(threads);
+    int per = (m + threads - 1) / threads;
+    for (int t = 0; t < threads; ++t) {
+        tasks[t] = { lu, n, R.data(), m, std::min(t * per, m), std::min((t + 1) * per, m) };
+    }
+
+    // столбцы потока, который не создался, считает главный поток
+    int started = 1;
+    while (started < threads && pthread_create(&ids[started], nullptr, SolveColumns<T>, &tasks[started]) == 0) ++started;
+    for (int t = started; t < threads; ++t) SolveColumns<T>(&tasks[t]);
+    SolveColumns<T>(&tasks[0]);
+    for (int t = 1; t < started; ++t)
+        pthread_join(ids[t], nullptr);
+}
+
+void SolveLU(const LUFactors& f, std::vector<double>& R, int m, int threads)
+{
+    SolveParallel(f.lu.data(), f.n, R, m, threads);
+}
+
+void SolveLU(const std::vector<float>& lu, int n, std::vector<double>& R, int m, int threads)
+{
+    SolveParallel(lu.data(), n, R, m, threads);
+}
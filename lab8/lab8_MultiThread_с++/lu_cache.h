@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// LU-разложение без перестановок, хранящееся на месте:
+// под диагональю множители L (единичная диагональ не хранится), на и над ней — U
+struct LUFactors {
+    int n = 0;
+    uint64_t hash = 0;
+    std::vector<double> lu;
+};
+
+// Ключ кэша — FNV-1a по размеру и значениям матрицы
+uint64_t HashMatrix(const std::vector<double>& A, int n);
+std::string CachePath(const std::string& dir, uint64_t hash);
+
+// false, если файла нет или он от другой матрицы
+bool LoadLU(const std::string& path, uint64_t hash, int n, LUFactors& f);
+void SaveLU(const std::string& path, const LUFactors& f);
+
+// Решение L*U*X = R для m правых частей; R хранится по строкам (n x m) и заменяется на X.
+// Подстановки идут блоками строк. Если правых частей не меньше, чем потоков, между
+// потоками делятся столбцы, иначе — строки каждого блока (диагональный блок решает один поток).
+void SolveLU(const LUFactors& f, std::vector<double>& R, int m, int threads);
+
+// То же по разложению в одинарной точности (для уточнения смешанной точности)
+void SolveLU(const std::vector<float>& lu, int n, std::vector<double>& R, int m, int threads);
@@ -0,0 +1,265 @@
+#include "structured.h"
+#include <cmath>
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+MatrixStructure AnalyzeStructure(const std::vector<double>& A, int n)
+{
+    MatrixStructure s;
+    for (int i = 0; i < n; ++i) {
+        const double* row = &A[(size_t)i * n];
+        for (int j = 0; j < n; ++j) {
+            if (row[j] == 0.0) continue;
+            ++s.nnz;
+            if (i > j) s.lower = std::max(s.lower, i - j);
+            else s.upper = std::max(s.upper, j - i);
+        }
+    }
+    s.density = (double)s.nnz / ((double)n * n);
+
+    s.positiveDiagonal = true;
+    for (int i = 0; i < n && s.positiveDiagonal; ++i) s.positiveDiagonal = A[(size_t)i * n + i] > 0.0;
+
+    // симметрия проверяется плитками, чтобы столбцовый проход не вымывал кэш
+    const int TB = 64;
+    s.symmetric = true;
+    for (int I = 0; I < n && s.symmetric; I += TB)
+        for (int J = 0; J <= I && s.symmetric; J += TB)
+            for (int i = I; i < std::min(I + TB, n) && s.symmetric; ++i)
+                for (int j = J; j < std::min(J + TB, i); ++j)
+                    if (A[(size_t)i * n + j] != A[(size_t)j * n + i]) {
+                        s.symmetric = false;
+                        break;
+                    }
+    return s;
+}
+
+SolverPath ChoosePath(const MatrixStructure& s, int n)
+{
+    if (n < 3) return (s.symmetric && s.positiveDiagonal) ? SolverPath::Cholesky : SolverPath::Dense;
+    if (s.lower <= 1 && s.upper <= 1) return SolverPath::Tridiagonal;
+    // лента в четыре раза уже матрицы — ленточное разложение уже выгоднее плотного
+    if ((long long)(s.lower + s.upper + 1) * 4 <= n) return SolverPath::Banded;
+    if (s.density <= 0.05) return SolverPath::Sparse;
+    if (s.symmetric && s.positiveDiagonal) return SolverPath::Cholesky;
+    return SolverPath::Dense;
+}
+
+const char* SolverPathName(SolverPath p)
+{
+    switch (p) {
+        case SolverPath::Dense: return "dense";
+        case SolverPath::Cholesky: return "cholesky";
+        case SolverPath::Tridiagonal: return "tridiagonal";
+        case SolverPath::Banded: return "banded";
+        case SolverPath::Sparse: return "sparse";
+    }
+    return "?";
+}
+
+static void ZeroPivot(int i)
+{
+    throw std::runtime_error("Нулевой ведущий элемент в строке " + std::to_string(i));
+}
+
+void SolveTridiagonal(const std::vector<double>& A, int n, std::vector<double>& R, int m)
+{
+    auto a = [&](int i) { return A[(size_t)i * n + i - 1]; };   // под диагональю
+    auto b = [&](int i) { return A[(size_t)i * n + i]; };
+    auto c = [&](int i) { return A[(size_t)i * n + i + 1]; };   // над диагональю
+
+    // прямая прогонка: cp — новые наддиагональные коэффициенты, R — новые правые части
+    std::vector<double> cp(n, 0.0);
+    double denom = b(0);
+    if (denom == 0.0) ZeroPivot(0);
+    cp[0] = c(0) / denom;
+    for (int t = 0; t < m; ++t) R[t] /= denom;
+    for (int i = 1; i < n; ++i) {
+        denom = b(i) - a(i) * cp[i - 1];
+        if (denom == 0.0) ZeroPivot(i);
+        if (i + 1 < n) cp[i] = c(i) / denom;
+        double* ri = &R[(size_t)i * m];
+        const double* rp = &R[(size_t)(i - 1) * m];
+        for (int t = 0; t < m; ++t) ri[t] = (ri[t] - a(i) * rp[t]) / denom;
+    }
+    for (int i = n - 2; i >= 0; --i) {
+        double* ri = &R[(size_t)i * m];
+        const double* rn = &R[(size_t)(i + 1) * m];
+        for (int t = 0; t < m; ++t) ri[t] -= cp[i] * rn[t];
+    }
+}
+
+void SolveBanded(const std::vector<double>& A, int n, int kl, int ku, std::vector<double>& R, int m)
+{
+    // строка i ленты: элементы j = i-kl..i+ku, элемент (i,j) лежит в ab[i*w + j-i+kl]
+    const int w = kl + ku + 1;
+    std::vector<double> ab((size_t)n * w, 0.0);
+    for (int i = 0; i < n; ++i)
+        for (int j = std::max(0, i - kl); j <= std::min(n - 1, i + ku); ++j)
+            ab[(size_t)i * w + j - i + kl] = A[(size_t)i * n + j];
+    auto at = [&](int i, int j) -> double& { return ab[(size_t)i * w + j - i + kl]; };
+
+    for (int k = 0; k < n; ++k) {
+        double pivot = at(k, k);
+        if (pivot == 0.0) ZeroPivot(k);
+        int jEnd = std::min(n - 1, k + ku);
+        for (int i = k + 1; i <= std::min(n - 1, k + kl); ++i) {
+            double& lik = at(i, k);
+            if (lik == 0.0) continue;
+            lik /= pivot;
+            for (int j = k + 1; j <= jEnd; ++j) at(i, j) -= lik * at(k, j);
+        }
+    }
+
+    for (int i = 0; i < n; ++i) {
+        double* ri = &R[(size_t)i * m];
+        for (int j = std::max(0, i - kl); j < i; ++j) {
+            double l = at(i, j);
+            if (l == 0.0) continue;
+            const double* rj = &R[(size_t)j * m];
+            for (int t = 0; t < m; ++t) ri[t] -= l * rj[t];
+        }
+    }
+    for (int i = n - 1; i >= 0; --i) {
+        double* ri = &R[(size_t)i * m];
+        for (int j = i + 1; j <= std::min(n - 1, i + ku); ++j) {
+            double u = at(i, j);
+            if (u == 0.0) continue;
+            const double* rj = &R[(size_t)j * m];
+            for (int t = 0; t < m; ++t) ri[t] -= u * rj[t];
+        }
+        for (int t = 0; t < m; ++t) ri[t] /= at(i, i);
+    }
+}
+
+// Минимальная степень на графе A + A^T: исключаемая вершина делает соседей кликой,
+// на каждом шаге берётся вершина с наименьшим числом соседей. perm[новый] = старый.
+static std::vector<int> MinimumDegreeOrder(const std::vector<double>& A, int n)
+{
+    std::vector<std::vector<int>> adj(n);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            if (i != j && (A[(size_t)i * n + j] != 0.0 || A[(size_t)j * n + i] != 0.0))
+                adj[i].push_back(j);
+
+    std::set<std::pair<int, int>> byDegree;
+    for (int v = 0; v < n; ++v) byDegree.insert({ (int)adj[v].size(), v });
+
+    std::vector<int> perm;
+    perm.reserve(n);
+    std::vector<int> merged;
+    while (!byDegree.empty()) {
+        // остаток почти полный: порядок на заполнение уже не влияет, а клики дорогие
+        int remaining = (int)byDegree.size();
+        if (byDegree.begin()->first * 2 >= remaining) {
+            for (auto& e : byDegree) perm.push_back(e.second);
+            break;
+        }
+        int v = byDegree.begin()->second;
+        byDegree.erase(byDegree.begin());
+        perm.push_back(v);
+
+        for (int u : adj[v]) {
+            byDegree.erase({ (int)adj[u].size(), u });
+            merged.clear();
+            std::set_union(adj[u].begin(), adj[u].end(), adj[v].begin(), adj[v].end(), std::back_inserter(merged));
+            adj[u].clear();
+            for (int x : merged)
+                if (x != u && x != v) adj[u].push_back(x);
+            byDegree.insert({ (int)adj[u].size(), u });
+        }
+        adj[v].clear();
+        adj[v].shrink_to_fit();
+    }
+    return perm;
+}
+
+void SolveSparse(const std::vector<double>& A, int n, std::vector<double>& R, int m, long long* fill)
+{
+    std::vector<int> perm = MinimumDegreeOrder(A, n);
+    std::vector<int> inv(n);
+    for (int i = 0; i < n; ++i) inv[perm[i]] = i;
+
+    // L — множители под диагональю, U — диагональ первой в строке, затем остальные по возрастанию
+    std::vector<int> Lp(1, 0), Lj, Up(1, 0), Uj;
+    std::vector<double> Lx, Ux;
+
+    std::vector<double> w(n, 0.0);
+    std::vector<char> mark(n, 0);
+    std::vector<int> cols;
+    std::priority_queue<int, std::vector<int>, std::greater<int>> lower;
+
+    // Строка i переставленной матрицы исключается готовыми строками U (порядок i-k-j)
+    for (int i = 0; i < n; ++i) {
+        const double* row = &A[(size_t)perm[i] * n];
+        cols.clear();
+        for (int jOld = 0; jOld < n; ++jOld) {
+            if (row[jOld] == 0.0) continue;
+            int j = inv[jOld];
+            w[j] = row[jOld];
+            mark[j] = 1;
+            cols.push_back(j);
+            if (j < i) lower.push(j);
+        }
+
+        while (!lower.empty()) {
+            int k = lower.top();
+            lower.pop();
+            double lik = w[k] / Ux[Up[k]];
+            if (lik == 0.0) continue;
+            Lj.push_back(k);
+            Lx.push_back(lik);
+            for (int p = Up[k] + 1; p < Up[k + 1]; ++p) {
+                int j = Uj[p];
+                if (!mark[j]) {
+                    mark[j] = 1;
+                    w[j] = 0.0;
+                    cols.push_back(j);
+                    if (j < i) lower.push(j);
+                }
+                w[j] -= lik * Ux[p];
+            }
+        }
+        Lp.push_back((int)Lj.size());
+
+        if (!mark[i] || w[i] == 0.0) ZeroPivot(perm[i]);
+        Uj.push_back(i);
+        Ux.push_back(w[i]);
+        std::sort(cols.begin(), cols.end());
+        for (int j : cols) {
+            if (j > i) {
+                Uj.push_back(j);
+                Ux.push_back(w[j]);
+            }
+            mark[j] = 0;
+            w[j] = 0.0;
+        }
+        Up.push_back((int)Uj.size());
+    }
+    if (fill) *fill = (long long)Lx.size() + (long long)Ux.size();
+
+    std::vector<double> y((size_t)n * m);
+    for (int i = 0; i < n; ++i)
+        std::copy(&R[(size_t)perm[i] * m], &R[(size_t)perm[i] * m] + m, &y[(size_t)i * m]);
+    for (int i = 0; i < n; ++i) {
+        double* yi = &y[(size_t)i * m];
+        for (int p = Lp[i]; p < Lp[i + 1]; ++p) {
+            const double* yk = &y[(size_t)Lj[p] * m];
+            for (int t = 0; t < m; ++t) yi[t] -= Lx[p] * yk[t];
+        }
+    }
+    for (int i = n - 1; i >= 0; --i) {
+        double* yi = &y[(size_t)i * m];
+        for (int p = Up[i] + 1; p < Up[i + 1]; ++p) {
+            const double* yj = &y[(size_t)Uj[p] * m];
+            for (int t = 0; t < m; ++t) yi[t] -= Ux[p] * yj[t];
+        }
+        for (int t = 0; t < m; ++t) yi[t] /= Ux[Up[i]];
+    }
+    for (int i = 0; i < n; ++i)
+        std::copy(&y[(size_t)i * m], &y[(size_t)i * m] + m, &R[(size_t)perm[i] * m]);
+}
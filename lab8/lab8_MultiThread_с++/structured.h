@@ -0,0 +1,32 @@
+#pragma once
+#include <vector>
+
+// Какой решатель подходит матрице по её структуре
+enum class SolverPath {
+    Dense,         // обычное разложение на пуле потоков
+    Cholesky,      // симметричная с положительной диагональю: блочный Холецкий, при срыве — LU
+    Tridiagonal,   // метод прогонки (Томаса)
+    Banded,        // ленточное LU, заполнение не выходит за ленту
+    Sparse         // разреженное LU в CSR с упорядочением минимальной степени
+};
+
+struct MatrixStructure {
+    long long nnz = 0;
+    double density = 0.0;
+    int lower = 0;   // число поддиагоналей: max(i - j) по ненулевым
+    int upper = 0;   // число наддиагоналей: max(j - i) по ненулевым
+    bool symmetric = false;          // A == A^T точно
+    bool positiveDiagonal = false;   // необходимое условие положительной определённости
+};
+
+MatrixStructure AnalyzeStructure(const std::vector<double>& A, int n);
+SolverPath ChoosePath(const MatrixStructure& s, int n);
+const char* SolverPathName(SolverPath p);
+
+// Все решатели без выбора ведущего элемента, как и плотный. A не меняется,
+// R (n x m по строкам) заменяется на X. Нулевой ведущий элемент — исключение.
+void SolveTridiagonal(const std::vector<double>& A, int n, std::vector<double>& R, int m);
+void SolveBanded(const std::vector<double>& A, int n, int kl, int ku, std::vector<double>& R, int m);
+
+// fill — число ненулевых в L и U после разложения
+void SolveSparse(const std::vector<double>& A, int n, std::vector<double>& R, int m, long long* fill = nullptr);
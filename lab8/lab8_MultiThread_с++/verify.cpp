@@ -0,0 +1,111 @@
+#include "verify.h"
+#include <pthread.h>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+static const int VERIFY_COL_BLOCK = 512;
+
+struct VerifyTask {
+    const double* A;
+    const double* B;
+    const double* X;
+    double* R;
+    int n;
+    int m;
+    int r0;
+    int r1;
+    double normA;   // максимум строчных сумм по своим строкам
+};
+
+// Сложение по Ноймайеру: s + comp — сумма с поправкой на потерянные младшие биты
+static inline void NeumaierAdd(double& s, double& comp, double v)
+{
+    double t = s + v;
+    if (std::abs(s) >= std::abs(v)) comp += (s - t) + v;
+    else comp += (v - t) + s;
+    s = t;
+}
+
+static void* VerifyRows(void* arg)
+{
+    VerifyTask* t = (VerifyTask*)arg;
+    const int n = t->n;
+    const int m = t->m;
+    int rows = t->r1 - t->r0;
+    std::vector<double> sum((size_t)rows * m), comp((size_t)rows * m, 0.0), absRow(rows, 0.0);
+
+    for (int i = t->r0; i < t->r1; ++i)
+        for (int c = 0; c < m; ++c) sum[(size_t)(i - t->r0) * m + c] = t->B[(size_t)i * m + c];
+
+    for (int j0 = 0; j0 < n; j0 += VERIFY_COL_BLOCK) {
+        int j1 = std::min(j0 + VERIFY_COL_BLOCK, n);
+        for (int i = t->r0; i < t->r1; ++i) {
+            const double* row = t->A + (size_t)i * n;
+            double* s = &sum[(size_t)(i - t->r0) * m];
+            double* e = &comp[(size_t)(i - t->r0) * m];
+            double a = 0.0;
+            for (int j = j0; j < j1; ++j) {
+                double aij = row[j];
+                a += std::abs(aij);
+                if (aij == 0.0) continue;
+                const double* xj = t->X + (size_t)j * m;
+                for (int c = 0; c < m; ++c) NeumaierAdd(s[c], e[c], -aij * xj[c]);
+            }
+            absRow[i - t->r0] += a;
+        }
+    }
+
+    t->normA = 0.0;
+    for (int i = 0; i < rows; ++i) {
+        t->normA = std::max(t->normA, absRow[i]);
+        for (int c = 0; c < m; ++c)
+            t->R[(size_t)(t->r0 + i) * m + c] = sum[(size_t)i * m + c] + comp[(size_t)i * m + c];
+    }
+    return nullptr;
+}
+
+VerifyResult VerifySolution(const std::vector<double>& A, int n, const std::vector<double>& B,
+                            const std::vector<double>& X, int m, int threads, std::vector<double>* R)
+{
+    std::vector<double> localR;
+    std::vector<double>& res = R ? *R : localR;
+    res.assign((size_t)n * m, 0.0);
+
+    threads = std::max(1, std::min(threads, n));
+    std::vector<VerifyTask> tasks(threads);
+    std::vector<pthread_t> ids(threads);
+    int per = (n + threads - 1) / threads;
+    for (int t = 0; t < threads; ++t)
+        tasks[t] = { A.data(), B.data(), X.data(), res.data(), n, m,
+                     std::min(t * per, n), std::min((t + 1) * per, n), 0.0 };
+
+    for (int t = 1; t < threads; ++t)
+        if (pthread_create(&ids[t], nullptr, VerifyRows, &tasks[t]) != 0)
+            throw std::runtime_error("Ошибка при создании потока " + std::to_string(t));
+    VerifyRows(&tasks[0]);
+    for (int t = 1; t < threads; ++t)
+        pthread_join(ids[t], nullptr);
+
+    VerifyResult vr;
+    for (auto& t : tasks) vr.normA = std::max(vr.normA, t.normA);
+
+    for (int c = 0; c < m; ++c) {
+        double nr = 0.0, nx = 0.0, nb = 0.0;
+        bool finite = true;
+        for (int i = 0; i < n; ++i) {
+            double r = res[(size_t)i * m + c], x = X[(size_t)i * m + c];
+            finite = finite && std::isfinite(r) && std::isfinite(x);
+            nr = std::max(nr, std::abs(r));
+            nx = std::max(nx, std::abs(x));
+            nb = std::max(nb, std::abs(B[(size_t)i * m + c]));
+        }
+        double denom = vr.normA * nx + nb;
+        // NaN/inf в решении должны провалить проверку, а не потеряться в max
+        double berr = !finite ? HUGE_VAL : (denom > 0.0 ? nr / denom : nr);
+        vr.residualNorm = std::max(vr.residualNorm, finite ? nr : HUGE_VAL);
+        vr.backwardError = std::max(vr.backwardError, berr);
+    }
+    return vr;
+}
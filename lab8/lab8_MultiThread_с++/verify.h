@@ -0,0 +1,16 @@
+#pragma once
+#include <vector>
+
+struct VerifyResult {
+    double residualNorm = 0.0;    // max по столбцам ||Ax - b||_inf
+    double backwardError = 0.0;   // max по столбцам ||Ax - b|| / (||A|| ||x|| + ||b||)
+    double normA = 0.0;           // ||A||_inf
+};
+
+// Невязка для m правых частей (B и X хранятся по строкам n x m).
+// Строки делятся между потоками, столбцы проходятся блоками, чтобы кусок X
+// оставался в кэше; суммы по строке компенсированные (Ноймайер).
+// Если R не nullptr, туда пишется сама невязка b - Ax.
+VerifyResult VerifySolution(const std::vector<double>& A, int n, const std::vector<double>& B,
+                            const std::vector<double>& X, int m, int threads,
+                            std::vector<double>* R = nullptr);
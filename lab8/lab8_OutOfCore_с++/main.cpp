@@ -0,0 +1,700 @@
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <vector>
+#include <deque>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstring>
+#include <climits>
+#include <cmath>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <stdexcept>
+
+// LU-разложение без выбора ведущего элемента для матриц, которые не помещаются в память.
+// Матрица лежит в файле плитками NB x NB, плитки одного столбца (панели) идут подряд.
+// Разложение левостороннее: панель k читается целиком, к ней применяются все готовые
+// панели 0..k-1 (читаются с диска потоком), затем панель раскладывается и пишется обратно.
+// Чтение следующих панелей и запись готовых идут в отдельном потоке ввода-вывода,
+// пока считается текущая. В памяти одновременно не больше пяти панелей.
+
+static const char TILE_MAGIC[8] = { 'L', 'A', 'B', '8', 'T', 'I', 'L', '\0' };
+static const off_t HEADER_BYTES = 8 + 2 * sizeof(long long);
+static const int PANEL_BUFFERS = 5;   // 3 текущих (счёт, запись, предвыборка) + 2 для потока старых
+
+static int N;
+static int NB;
+static int T;
+static size_t tileElems;
+
+static inline int TileSize(int i) { return std::min(NB, N - i * NB); }
+static inline off_t TileOffset(int col, int row) { return HEADER_BYTES + (off_t)(((size_t)col * T + row) * tileElems * sizeof(double)); }
+
+// ===================== Ввод-вывод =====================
+
+static void ReadAt(int fd, void* buf, size_t bytes, off_t offset)
+{
+    char* p = (char*)buf;
+    while (bytes > 0) {
+        ssize_t r = pread(fd, p, bytes, offset);
+        if (r <= 0) throw std::runtime_error(std::string("pread: ") + (r == 0 ? "unexpected end of file" : std::strerror(errno)));
+        p += r; bytes -= r; offset += r;
+    }
+}
+
+static void WriteAt(int fd, const void* buf, size_t bytes, off_t offset)
+{
+    const char* p = (const char*)buf;
+    while (bytes > 0) {
+        ssize_t r = pwrite(fd, p, bytes, offset);
+        if (r < 0) throw std::runtime_error(std::string("pwrite: ") + std::strerror(errno));
+        p += r; bytes -= r; offset += r;
+    }
+}
+
+// Очередь запросов к файлу, обслуживаемая одним потоком строго по порядку.
+// Порядок важен: запись панели всегда поставлена раньше её повторного чтения.
+class AsyncIO {
+public:
+    explicit AsyncIO(int fd) : fd(fd), worker(&AsyncIO::Loop, this) {}
+
+    ~AsyncIO()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stop = true;
+        }
+        cv.notify_all();
+        worker.join();
+    }
+
+    long Read(double* buf, size_t bytes, off_t offset) { return Submit({ false, buf, bytes, offset }); }
+    long Write(const double* buf, size_t bytes, off_t offset) { return Submit({ true, (double*)buf, bytes, offset }); }
+
+    void Wait(long ticket)
+    {
+        auto t0 = std::chrono::high_resolution_clock::now();
+        std::unique_lock<std::mutex> lock(m);
+        cvDone.wait(lock, [&] { return done >= ticket || !errorText.empty(); });
+        if (!errorText.empty()) throw std::runtime_error(errorText);
+        std::chrono::duration<double> w = std::chrono::high_resolution_clock::now() - t0;
+        waitSeconds += w.count();
+    }
+
+    void Drain() { Wait(submitted); }
+
+    long long bytesRead = 0;
+    long long bytesWritten = 0;
+    double busySeconds = 0.0;   // время работы потока ввода-вывода
+    double waitSeconds = 0.0;   // время, которое считающий поток простоял в Wait
+
+private:
+    struct Request {
+        bool write;
+        double* buf;
+        size_t bytes;
+        off_t offset;
+    };
+
+    long Submit(const Request& r)
+    {
+        long ticket;
+        {
+            std::lock_guard<std::mutex> lock(m);
+            queue.push_back(r);
+            ticket = ++submitted;
+        }
+        cv.notify_one();
+        return ticket;
+    }
+
+    void Loop()
+    {
+        for (;;) {
+            Request r;
+            {
+                std::unique_lock<std::mutex> lock(m);
+                cv.wait(lock, [&] { return stop || !queue.empty(); });
+                if (queue.empty()) return;
+                r = queue.front();
+                queue.pop_front();
+            }
+            auto t0 = std::chrono::high_resolution_clock::now();
+            std::string err;
+            try {
+                if (r.write) WriteAt(fd, r.buf, r.bytes, r.offset);
+                else ReadAt(fd, r.buf, r.bytes, r.offset);
+            }
+            catch (const std::exception& e) {
+                err = e.what();
+            }
+            std::chrono::duration<double> busy = std::chrono::high_resolution_clock::now() - t0;
+            {
+                std::lock_guard<std::mutex> lock(m);
+                busySeconds += busy.count();
+                (r.write ? bytesWritten : bytesRead) += r.bytes;
+                if (!err.empty() && errorText.empty()) errorText = err;
+                ++done;
+            }
+            cvDone.notify_all();
+        }
+    }
+
+    int fd;
+    std::mutex m;
+    std::condition_variable cv;
+    std::condition_variable cvDone;
+    std::deque<Request> queue;
+    long submitted = 0;
+    long done = 0;
+    bool stop = false;
+    std::string errorText;
+    std::thread worker;
+};
+
+// ===================== Потоки для счёта =====================
+
+// fn(i) для i из [begin, end); индексы раздаются через атомарный счётчик,
+// вызывающий поток работает вместе с пулом
+class WorkerPool {
+public:
+    explicit WorkerPool(int n)
+    {
+        for (int t = 1; t < n; ++t) threads.emplace_back(&WorkerPool::Loop, this);
+    }
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            terminate = true;
+        }
+        cvStart.notify_all();
+        for (auto& th : threads) th.join();
+    }
+
+    void ParallelFor(int begin, int end, const std::function<void(int)>& f)
+    {
+        if (end - begin <= 1 || threads.empty()) {
+            for (int i = begin; i < end; ++i) f(i);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m);
+            fn = &f;
+            next = begin;
+            last = end;
+            pending = (int)threads.size();
+            ++generation;
+        }
+        cvStart.notify_all();
+        Work();
+        std::unique_lock<std::mutex> lock(m);
+        cvDone.wait(lock, [this] { return pending == 0; });
+        fn = nullptr;
+        if (!errorText.empty()) {
+            std::string e;
+            e.swap(errorText);
+            throw std::runtime_error(e);
+        }
+    }
+
+private:
+    void Work()
+    {
+        for (int i; (i = next.fetch_add(1)) < last;) {
+            try {
+                (*fn)(i);
+            }
+            catch (const std::exception& e) {
+                std::lock_guard<std::mutex> lock(m);
+                if (errorText.empty()) errorText = e.what();
+            }
+        }
+    }
+
+    void Loop()
+    {
+        long seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(m);
+                cvStart.wait(lock, [&] { return generation != seen || terminate; });
+                if (terminate) return;
+                seen = generation;
+            }
+            Work();
+            {
+                std::lock_guard<std::mutex> lock(m);
+                --pending;
+            }
+            cvDone.notify_one();
+        }
+    }
+
+    std::vector<std::thread> threads;
+    std::mutex m;
+    std::condition_variable cvStart;
+    std::condition_variable cvDone;
+    const std::function<void(int)>* fn = nullptr;
+    std::atomic<int> next{ 0 };
+    int last = 0;
+    int pending = 0;
+    long generation = 0;
+    bool terminate = false;
+    std::string errorText;
+};
+
+// ===================== Ядра над плитками (ведущая размерность NB) =====================
+
+// Разложение диагональной плитки на месте
+static void KernelPanel(double* a, int k)
+{
+    int m = TileSize(k);
+    for (int p = 0; p < m; ++p) {
+        double app = a[(size_t)p * NB + p];
+        if (app == 0.0) throw std::runtime_error("Нулевой ведущий элемент в строке " + std::to_string(k * NB + p));
+        for (int r = p + 1; r < m; ++r) {
+            double* rowR = a + (size_t)r * NB;
+            const double* rowP = a + (size_t)p * NB;
+            double l = rowR[p] / app;
+            rowR[p] = l;
+            for (int c = p + 1; c < m; ++c) rowR[c] -= l * rowP[c];
+        }
+    }
+}
+
+// a = L^-1 * a, L — единичная нижняя из плитки l
+static void KernelRowSolve(const double* l, double* a, int m, int w)
+{
+    for (int p = 0; p < m; ++p) {
+        const double* rowP = a + (size_t)p * NB;
+        for (int r = p + 1; r < m; ++r) {
+            double f = l[(size_t)r * NB + p];
+            if (f == 0.0) continue;
+            double* rowR = a + (size_t)r * NB;
+            for (int c = 0; c < w; ++c) rowR[c] -= f * rowP[c];
+        }
+    }
+}
+
+// a = a * U^-1, U — верхняя из плитки u
+static void KernelColSolve(const double* u, double* a, int h, int m)
+{
+    for (int r = 0; r < h; ++r) {
+        double* rowR = a + (size_t)r * NB;
+        for (int p = 0; p < m; ++p) {
+            const double* rowU = u + (size_t)p * NB;
+            double l = rowR[p] / rowU[p];
+            rowR[p] = l;
+            if (l == 0.0) continue;
+            for (int c = p + 1; c < m; ++c) rowR[c] -= l * rowU[c];
+        }
+    }
+}
+
+// a -= l * u
+static void KernelUpdate(const double* l, const double* u, double* a, int h, int m, int w)
+{
+    for (int r = 0; r < h; ++r) {
+        double* __restrict rowA = a + (size_t)r * NB;
+        const double* rowL = l + (size_t)r * NB;
+        for (int p = 0; p < m; ++p) {
+            double f = rowL[p];
+            if (f == 0.0) continue;
+            const double* __restrict rowU = u + (size_t)p * NB;
+            for (int c = 0; c < w; ++c) rowA[c] -= f * rowU[c];
+        }
+    }
+}
+
+// ===================== Загрузка в плиточный файл =====================
+
+// Полоса из NB строк раскладывается по плиткам и пишется в файл
+static void WriteStrip(int fd, const std::vector<double>& strip, int I, std::vector<double>& tile)
+{
+    int h = TileSize(I);
+    for (int J = 0; J < T; ++J) {
+        int w = TileSize(J);
+        std::fill(tile.begin(), tile.end(), 0.0);
+        for (int r = 0; r < h; ++r)
+            std::copy(&strip[(size_t)r * N + (size_t)J * NB], &strip[(size_t)r * N + (size_t)J * NB] + w, &tile[(size_t)r * NB]);
+        WriteAt(fd, tile.data(), tileElems * sizeof(double), TileOffset(J, I));
+    }
+}
+
+static void WriteHeader(int fd)
+{
+    long long hdr[2] = { N, NB };
+    WriteAt(fd, TILE_MAGIC, sizeof(TILE_MAGIC), 0);
+    WriteAt(fd, hdr, sizeof(hdr), sizeof(TILE_MAGIC));
+}
+
+// Непустые строки B.txt — порядок системы
+static long long CountDataLines(const std::string& path)
+{
+    std::ifstream fin(path);
+    long long lines = 0;
+    std::string line;
+    while (std::getline(fin, line))
+        if (line.find_first_not_of(" \t\r") != std::string::npos) ++lines;
+    return lines;
+}
+
+// A.bin можно брать вместо A.txt: A.txt нет, либо A.bin не старше его, длина сходится
+// с заголовком и N равно числу строк B.txt. Иначе A.bin остался от прежней системы.
+static bool BinaryIsCurrent(const std::string& folder)
+{
+    struct stat bin, txt;
+    if (stat((folder + "/A.bin").c_str(), &bin) != 0) return false;
+    if (stat((folder + "/A.txt").c_str(), &txt) != 0) return true;
+    if (txt.st_mtim.tv_sec != bin.st_mtim.tv_sec ? txt.st_mtim.tv_sec > bin.st_mtim.tv_sec
+                                                 : txt.st_mtim.tv_nsec > bin.st_mtim.tv_nsec)
+        return false;
+    std::ifstream fin(folder + "/A.bin", std::ios::binary);
+    long long n = 0;
+    if (!fin.read((char*)&n, sizeof(n)) || n <= 0 || n > INT_MAX) return false;
+    if ((long long)bin.st_size != (long long)sizeof(n) + n * n * (long long)sizeof(double)) return false;
+    return CountDataLines(folder + "/B.txt") == n;
+}
+
+// Размер по A.bin (формат решателя MPI), если он не устарел, или по числу чисел в первой
+// строке A.txt
+static int ProbeSize(const std::string& folder, bool& fromBin)
+{
+    std::ifstream bin;
+    if (BinaryIsCurrent(folder)) bin.open(folder + "/A.bin", std::ios::binary);
+    if (bin.is_open()) {
+        long long n = 0;
+        bin.read((char*)&n, sizeof(n));
+        if (!bin || n <= 0) throw std::runtime_error("A.bin: bad header");
+        fromBin = true;
+        return (int)n;
+    }
+    std::ifstream fin(folder + "/A.txt");
+    if (!fin) throw std::runtime_error("Cannot open A.txt");
+    std::string line;
+    std::getline(fin, line);
+    std::istringstream ss(line);
+    int n = 0;
+    double v;
+    while (ss >> v) ++n;
+    if (n == 0) throw std::runtime_error("Empty A.txt");
+    fromBin = false;
+    return n;
+}
+
+// Потоковое преобразование: в памяти только полоса из NB строк
+static void BuildTileFile(const std::string& folder, bool fromBin, int fd)
+{
+    WriteHeader(fd);
+    std::vector<double> strip((size_t)NB * N), tile(tileElems);
+
+    if (fromBin) {
+        int bfd = open((folder + "/A.bin").c_str(), O_RDONLY);
+        if (bfd < 0) throw std::runtime_error("Cannot open A.bin");
+        for (int I = 0; I < T; ++I) {
+            ReadAt(bfd, strip.data(), (size_t)TileSize(I) * N * sizeof(double),
+                   sizeof(long long) + (off_t)I * NB * N * sizeof(double));
+            WriteStrip(fd, strip, I, tile);
+        }
+        close(bfd);
+        return;
+    }
+
+    std::ifstream fin(folder + "/A.txt");
+    std::string line;
+    int i = 0;
+    while (i < N && std::getline(fin, line)) {
+        std::istringstream ss(line);
+        double* row = &strip[(size_t)(i % NB) * N];
+        int j = 0;
+        while (j < N && ss >> row[j]) ++j;
+        if (j == 0) continue;
+        if (j != N) throw std::runtime_error("A.txt: inconsistent row size");
+        ++i;
+        if (i % NB == 0 || i == N) WriteStrip(fd, strip, (i - 1) / NB, tile);
+    }
+    if (i != N) throw std::runtime_error("A.txt: not enough rows");
+}
+
+static void ReadVector(const std::string& path, std::vector<double>& V, int n)
+{
+    std::ifstream fin(path);
+    if (!fin) throw std::runtime_error("Cannot open " + path);
+    V.assign(n, 0.0);
+    for (int i = 0; i < n; ++i)
+        if (!(fin >> V[i])) throw std::runtime_error(path + " not match size");
+}
+
+void WriteVector(const std::string& path, const std::vector<double>& X)
+{
+    std::ofstream fout(path);
+    fout << std::setprecision(17);
+    for (double v : X) fout << v << "\n";
+}
+
+// ===================== Разложение и подстановки =====================
+
+struct Panels {
+    std::vector<double> cur[3];
+    std::vector<double> prev[2];
+    long curTicket[3] = { 0, 0, 0 };
+    long prevTicket[2] = { 0, 0 };
+};
+
+static inline double* TileIn(std::vector<double>& panel, int i) { return panel.data() + (size_t)i * tileElems; }
+
+// Плитки row..T-1 панели col — непрерывный кусок файла; в буфере лежат на своих местах
+static long ReadPanel(AsyncIO& io, std::vector<double>& buf, int col, int row0, int row1)
+{
+    return io.Read(TileIn(buf, row0), (size_t)(row1 - row0) * tileElems * sizeof(double), TileOffset(col, row0));
+}
+
+// Применение готовой панели p к панели k: U(p,k) = L(p,p)^-1 A(p,k), затем A(i,k) -= L(i,p) U(p,k)
+static void ApplyPanel(std::vector<double>& L, std::vector<double>& P, int p, int k, WorkerPool& pool)
+{
+    KernelRowSolve(TileIn(L, p), TileIn(P, p), TileSize(p), TileSize(k));
+    pool.ParallelFor(p + 1, T, [&](int i) {
+        KernelUpdate(TileIn(L, i), TileIn(P, p), TileIn(P, i), TileSize(i), TileSize(p), TileSize(k));
+    });
+}
+
+// Прямой ход по столбцу k единичной L: y сразу обновляется готовой панелью
+static void ForwardPanel(std::vector<double>& P, int k, std::vector<double>& y)
+{
+    const double* d = TileIn(P, k);
+    int m = TileSize(k);
+    double* yk = &y[(size_t)k * NB];
+    for (int r = 0; r < m; ++r)
+        for (int c = 0; c < r; ++c) yk[r] -= d[(size_t)r * NB + c] * yk[c];
+    for (int i = k + 1; i < T; ++i) {
+        const double* l = TileIn(P, i);
+        double* yi = &y[(size_t)i * NB];
+        for (int r = 0; r < TileSize(i); ++r) {
+            double s = 0.0;
+            for (int c = 0; c < m; ++c) s += l[(size_t)r * NB + c] * yk[c];
+            yi[r] -= s;
+        }
+    }
+}
+
+// Обратный ход по столбцу p верхней U (нужны плитки 0..p)
+static void BackwardPanel(std::vector<double>& P, int p, std::vector<double>& y)
+{
+    const double* d = TileIn(P, p);
+    int m = TileSize(p);
+    double* xp = &y[(size_t)p * NB];
+    for (int r = m - 1; r >= 0; --r) {
+        for (int c = r + 1; c < m; ++c) xp[r] -= d[(size_t)r * NB + c] * xp[c];
+        xp[r] /= d[(size_t)r * NB + r];
+    }
+    for (int i = 0; i < p; ++i) {
+        const double* u = TileIn(P, i);
+        double* yi = &y[(size_t)i * NB];
+        for (int r = 0; r < NB; ++r) {
+            double s = 0.0;
+            for (int c = 0; c < m; ++c) s += u[(size_t)r * NB + c] * xp[c];
+            yi[r] -= s;
+        }
+    }
+}
+
+// Левостороннее разложение с прямым ходом по y; после выхода в cur лежат последние три панели
+static void FactorOutOfCore(AsyncIO& io, Panels& b, std::vector<double>& y, WorkerPool& pool, double& factorSeconds)
+{
+    auto f0 = std::chrono::high_resolution_clock::now();
+    b.curTicket[0] = ReadPanel(io, b.cur[0], 0, 0, T);
+
+    for (int k = 0; k < T; ++k) {
+        std::vector<double>& P = b.cur[k % 3];
+        io.Wait(b.curTicket[k % 3]);
+
+        // панели 0..k-2 читаются с диска (по две вперёд), k-1 ещё в памяти
+        int streamEnd = std::max(k - 1, 0);
+        bool nextSubmitted = false;
+        auto submitNext = [&] {
+            if (nextSubmitted || k + 1 >= T) return;
+            b.curTicket[(k + 1) % 3] = ReadPanel(io, b.cur[(k + 1) % 3], k + 1, 0, T);
+            nextSubmitted = true;
+        };
+        for (int s = 0; s < std::min(2, streamEnd); ++s)
+            b.prevTicket[s % 2] = ReadPanel(io, b.prev[s % 2], s, s, T);
+        if (streamEnd <= 2) submitNext();
+
+        for (int p = 0; p < k; ++p) {
+            if (p < streamEnd) {
+                io.Wait(b.prevTicket[p % 2]);
+                ApplyPanel(b.prev[p % 2], P, p, k, pool);
+                if (p + 2 < streamEnd) b.prevTicket[p % 2] = ReadPanel(io, b.prev[p % 2], p + 2, p + 2, T);
+                else submitNext();
+            }
+            else {
+                ApplyPanel(b.cur[(k + 2) % 3], P, p, k, pool);
+            }
+        }
+        submitNext();
+
+        KernelPanel(TileIn(P, k), k);
+        pool.ParallelFor(k + 1, T, [&](int i) {
+            KernelColSolve(TileIn(P, k), TileIn(P, i), TileSize(i), TileSize(k));
+        });
+        ForwardPanel(P, k, y);
+
+        b.curTicket[k % 3] = io.Write(P.data(), (size_t)T * tileElems * sizeof(double), TileOffset(k, 0));
+    }
+    std::chrono::duration<double> f = std::chrono::high_resolution_clock::now() - f0;
+    factorSeconds = f.count();
+}
+
+static void BackSubstitution(AsyncIO& io, Panels& b, std::vector<double>& y)
+{
+    // три последние панели ещё в памяти, остальные читаются с конца по две вперёд
+    int firstStreamed = T - 4;
+    for (int s = 0; s < 2 && firstStreamed - s >= 0; ++s)
+        b.prevTicket[s % 2] = ReadPanel(io, b.prev[s % 2], firstStreamed - s, 0, firstStreamed - s + 1);
+
+    for (int p = T - 1; p >= 0; --p) {
+        if (p > firstStreamed) {
+            BackwardPanel(b.cur[p % 3], p, y);
+            continue;
+        }
+        int s = firstStreamed - p;
+        io.Wait(b.prevTicket[s % 2]);
+        BackwardPanel(b.prev[s % 2], p, y);
+        int nextP = p - 2;
+        if (nextP >= 0) b.prevTicket[s % 2] = ReadPanel(io, b.prev[s % 2], nextP, 0, nextP + 1);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cerr << "Ожидался аргумент — путь к папке с данными\n";
+        std::cerr << "Использование: ooc_main <папка> [--memory=МБ] [--tile=NB] [--threads=T] [--work=ФАЙЛ] [--keep]\n";
+        return 1;
+    }
+
+    std::string folder, workPath;
+    long long memoryMB = 1024;
+    int tileArg = 0;
+    int numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    bool keep = false;
+    try {
+        for (int a = 1; a < argc; ++a) {
+            std::string arg = argv[a];
+            if (arg.rfind("--threads=", 0) == 0) numThreads = std::stoi(arg.substr(10));
+            else if (arg.rfind("--tile=", 0) == 0) tileArg = std::stoi(arg.substr(7));
+            else if (arg.rfind("--memory=", 0) == 0) memoryMB = std::stoll(arg.substr(9));
+            else if (arg.rfind("--work=", 0) == 0) workPath = arg.substr(7);
+            else if (arg == "--keep") keep = true;
+            else folder = arg;
+        }
+        if (tileArg < 0 || memoryMB <= 0) throw std::runtime_error("--tile and --memory must be positive");
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    if (numThreads <= 0) numThreads = 1;
+    if (workPath.empty()) workPath = folder + "/LU.tiles";
+
+    std::vector<double> X;
+    double loadSeconds = 0.0, factorSeconds = 0.0, solveSeconds = 0.0;
+    long long budget = memoryMB << 20;
+    long long used = 0;
+    long long ioRead = 0, ioWritten = 0;
+    double ioBusy = 0.0, ioWait = 0.0;
+    int fd = -1;
+
+    try {
+        bool fromBin = false;
+        N = ProbeSize(folder, fromBin);
+
+        // Плитка подбирается так, чтобы пять панелей N x NB уложились в бюджет
+        if (tileArg > 0) NB = tileArg;
+        else {
+            long long fit = budget / ((long long)PANEL_BUFFERS * N * sizeof(double));
+            NB = (int)std::min<long long>(fit / 16 * 16, 1024);
+            NB = std::min(NB, (N + 15) / 16 * 16);
+        }
+        if (NB <= 0) throw std::runtime_error("Бюджет памяти слишком мал для N = " + std::to_string(N));
+        T = (N + NB - 1) / NB;
+        tileElems = (size_t)NB * NB;
+        used = (long long)PANEL_BUFFERS * T * tileElems * sizeof(double);
+        if (used > budget)
+            std::cerr << "Предупреждение: плитка " << NB << " требует " << (used >> 20) << " МБ при бюджете " << memoryMB << " МБ\n";
+
+        auto l0 = std::chrono::high_resolution_clock::now();
+        fd = open(workPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) throw std::runtime_error("Cannot create " + workPath);
+        BuildTileFile(folder, fromBin, fd);
+        std::vector<double> y;
+        ReadVector(folder + "/B.txt", y, N);
+        y.resize((size_t)T * NB, 0.0);
+        std::chrono::duration<double> l = std::chrono::high_resolution_clock::now() - l0;
+        loadSeconds = l.count();
+
+        Panels b;
+        for (auto& v : b.cur) v.assign((size_t)T * tileElems, 0.0);
+        for (auto& v : b.prev) v.assign((size_t)T * tileElems, 0.0);
+
+        {
+            WorkerPool pool(numThreads);
+            AsyncIO io(fd);
+            FactorOutOfCore(io, b, y, pool, factorSeconds);
+
+            auto s0 = std::chrono::high_resolution_clock::now();
+            BackSubstitution(io, b, y);
+            io.Drain();
+            std::chrono::duration<double> s = std::chrono::high_resolution_clock::now() - s0;
+            solveSeconds = s.count();
+
+            ioRead = io.bytesRead;
+            ioWritten = io.bytesWritten;
+            ioBusy = io.busySeconds;
+            ioWait = io.waitSeconds;
+        }
+        close(fd);
+        fd = -1;
+        y.resize(N);
+        X.swap(y);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        if (fd >= 0) close(fd);
+        if (!keep) unlink(workPath.c_str());
+        return 2;
+    }
+    if (!keep) unlink(workPath.c_str());
+
+    WriteVector(folder + "/X.txt", X);
+
+    // перекрытие — доля времени ввода-вывода, спрятанная за счётом
+    double overlap = ioBusy > 0.0 ? std::max(0.0, 1.0 - ioWait / ioBusy) : 1.0;
+    std::cout << "==============================================\n";
+    std::cout << "Размер матрицы: " << N << "x" << N << "\n";
+    std::cout << "Потоков: " << numThreads << "\n";
+    std::cout << "Плитка: " << NB << " (" << T << "x" << T << " плиток)\n";
+    std::cout << "Память: " << used / 1048576.0 << " МБ из " << memoryMB << " МБ (матрица "
+              << (double)T * T * tileElems * sizeof(double) / 1048576.0 << " МБ)\n";
+    std::cout << "Загрузка в файл плиток: " << loadSeconds * 1000 << " мс\n";
+    std::cout << "Прочитано: " << ioRead / 1048576.0 << " МБ, записано: " << ioWritten / 1048576.0 << " МБ\n";
+    std::cout << "Ввод-вывод: " << ioBusy * 1000 << " мс, ожидание: " << ioWait * 1000
+              << " мс, перекрытие: " << overlap * 100 << "%\n";
+    std::cout << "Разложение: " << factorSeconds * 1000 << " мс\n";
+    std::cout << "Подстановки: " << solveSeconds * 1000 << " мс\n";
+    std::cout << "Время: " << (factorSeconds + solveSeconds) * 1000 << " мс\n";
+    std::cout << "==============================================\n";
+
+    return 0;
+}
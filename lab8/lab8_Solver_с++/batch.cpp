@@ -0,0 +1,205 @@
+#include "batch.h"
+#include "engine.h"
+#include "kernel.h"
+#include "condition.h"
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <utility>
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+void SystemBatch::Resize(long long count, int n)
+{
+    if (count < 0 || n <= 0) throw std::runtime_error("Invalid batch size");
+    this->count = count;
+    this->n = n;
+    const long long groups = Groups();
+    a.Resize((int)groups, n * n * BatchLanes);
+    b.Resize((int)groups, n * BatchLanes);
+    x.Resize((int)groups, n * BatchLanes);
+    // дополнение последней группы: E x = 0, решается без особых случаев
+    for (long long s = count; s < groups * BatchLanes; ++s)
+        for (int i = 0; i < n; ++i) A(s, i, i) = 1.0;
+}
+
+static void ReadExact(std::FILE* f, void* buf, size_t bytes, const std::string& path)
+{
+    if (std::fread(buf, 1, bytes, f) != bytes) throw std::runtime_error("Unexpected end of " + path);
+}
+
+void ReadBatch(const std::string& folder, SystemBatch& sys)
+{
+    const std::string path = folder + "/batch.bin";
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) throw std::runtime_error("Cannot open " + path);
+    try {
+        long long header[2];
+        ReadExact(f, header, sizeof(header), path);
+        if (header[0] <= 0 || header[1] <= 0 || header[1] > 4096) throw std::runtime_error("Invalid header in " + path);
+        const int n = (int)header[1];
+        sys.Resize(header[0], n);
+
+        // группа читается одним fread и раскладывается по векторам
+        const size_t perSystem = (size_t)n * n + n;
+        std::vector<double> buf(perSystem * BatchLanes);
+        for (long long s0 = 0; s0 < sys.Count(); s0 += BatchLanes) {
+            const int lanes = (int)std::min<long long>(BatchLanes, sys.Count() - s0);
+            ReadExact(f, buf.data(), perSystem * lanes * sizeof(double), path);
+            for (int l = 0; l < lanes; ++l) {
+                const double* src = buf.data() + perSystem * l;
+                for (int i = 0; i < n; ++i)
+                    for (int j = 0; j < n; ++j) sys.A(s0 + l, i, j) = src[(size_t)i * n + j];
+                for (int i = 0; i < n; ++i) sys.B(s0 + l, i) = src[(size_t)n * n + i];
+            }
+        }
+    }
+    catch (...) {
+        std::fclose(f);
+        throw;
+    }
+    std::fclose(f);
+}
+
+void WriteBatchSolution(const std::string& path, const SystemBatch& sys)
+{
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) throw std::runtime_error("Cannot create " + path);
+    long long header[2] = { sys.Count(), sys.Order() };
+    bool ok = std::fwrite(header, sizeof(header), 1, f) == 1;
+    std::vector<double> row(sys.Order());
+    for (long long s = 0; s < sys.Count() && ok; ++s) {
+        for (int i = 0; i < sys.Order(); ++i) row[i] = sys.X(s, i);
+        ok = std::fwrite(row.data(), sizeof(double), row.size(), f) == row.size();
+    }
+    if (std::fclose(f) != 0 || !ok) throw std::runtime_error("Cannot write " + path);
+}
+
+// Порядки с развёрнутой версией ядра: все малые и несколько круглых до 64
+const int BatchMaxFixed = 64;
+typedef std::integer_sequence<int, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 20, 24, 32, 48, 64> FixedOrders;
+
+namespace batch_generic {
+#define LAB8_BATCH_TARGET
+#include "batch_kernel.inc"
+#undef LAB8_BATCH_TARGET
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define LAB8_X86 1
+namespace batch_avx2 {
+#define LAB8_BATCH_TARGET __attribute__((target("avx2,fma")))
+#include "batch_kernel.inc"
+#undef LAB8_BATCH_TARGET
+}
+namespace batch_avx512 {
+#define LAB8_BATCH_TARGET __attribute__((target("avx512f,fma")))
+#include "batch_kernel.inc"
+#undef LAB8_BATCH_TARGET
+}
+#endif
+
+template <int... S>
+static bool Contains(int n, std::integer_sequence<int, S...>)
+{
+    return ((n == S) || ...);
+}
+
+bool BatchFixedOrder(int n) { return Contains(n, FixedOrders()); }
+
+// Ядро группы для порядка n под текущий набор инструкций ядра исключения
+static batch_generic::GroupFn PickGroupKernel(int n, bool generic)
+{
+    static batch_generic::GroupFn tables[3][BatchMaxFixed + 1];
+    static const bool filled = [] {
+        batch_generic::FillTable(tables[0]);
+#ifdef LAB8_X86
+        batch_avx2::FillTable(tables[1]);
+        batch_avx512::FillTable(tables[2]);
+#else
+        batch_generic::FillTable(tables[1]);
+        batch_generic::FillTable(tables[2]);
+#endif
+        return true;
+    }();
+    (void)filled;
+    const std::string isa = KernelName();
+    const int t = isa == "avx512" ? 2 : isa == "avx2" ? 1 : 0;
+    return tables[t][(generic || n > BatchMaxFixed) ? 0 : n];
+}
+
+// Одна система заново, с выбором ведущего элемента
+static bool SolvePivoted(SystemBatch& sys, long long s)
+{
+    const int n = sys.Order();
+    Matrix LU(n, n), B(n, 1), X;
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) LU(i, j) = sys.A(s, i, j);
+        B(i, 0) = sys.B(s, i);
+    }
+    std::vector<int> perm;
+    try {
+        FactorPivoted(LU, perm);
+    }
+    catch (const std::exception&) {
+        for (int i = 0; i < n; ++i) sys.X(s, i) = NAN;
+        return false;
+    }
+    PermuteRows(perm, B, X);
+    SolveLU(LU, X, 1);
+    for (int i = 0; i < n; ++i) sys.X(s, i) = X(i, 0);
+    return true;
+}
+
+BatchStats SolveBatch(SystemBatch& sys, int threads, bool generic)
+{
+    const int n = sys.Order();
+    const long long groups = sys.Groups();
+    const batch_generic::GroupFn fn = PickGroupKernel(n, generic);
+    // порциями по GROUPS_PER_TASK: мелкие системы решаются за сотни наносекунд,
+    // и раздавать их по одной дороже самого решения
+    const long long GROUPS_PER_TASK = 64;
+    threads = (int)std::max(1LL, std::min<long long>(threads, (groups + GROUPS_PER_TASK - 1) / GROUPS_PER_TASK));
+
+    // порог как у solver_main --ill: ведущий элемент не больше n * eps * max|A|
+    const double tol = n * DBL_EPSILON;
+    std::atomic<long long> next(0), pivoted(0), singular(0);
+    auto worker = [&]() {
+        Matrix work(1, n * (n + 1) * BatchLanes);
+        alignas(64) double minPivot[BatchLanes];
+        long long myPivoted = 0, mySingular = 0;
+        while (true) {
+            long long g0 = next.fetch_add(GROUPS_PER_TASK);
+            if (g0 >= groups) break;
+            long long g1 = std::min(g0 + GROUPS_PER_TASK, groups);
+            for (long long g = g0; g < g1; ++g) {
+                fn(n, sys.GroupA(g), sys.GroupB(g), sys.GroupX(g), work.Row(0), minPivot);
+                for (int l = 0; l < BatchLanes; ++l) {
+                    long long s = g * BatchLanes + l;
+                    if (s >= sys.Count()) break;
+                    bool stable = minPivot[l] >= tol;   // NaN (нулевая A) — тоже заново
+                    for (int i = 0; i < n && stable; ++i) stable = std::isfinite(sys.X(s, i));
+                    if (stable) continue;
+                    ++myPivoted;
+                    if (!SolvePivoted(sys, s)) ++mySingular;
+                }
+            }
+        }
+        pivoted += myPivoted;
+        singular += mySingular;
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+
+    BatchStats stats;
+    stats.pivoted = pivoted;
+    stats.singular = singular;
+    return stats;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <string>
+#include "matrix.h"
+
+// Пакет из Count() независимых систем порядка Order() с одной правой частью у каждой.
+// Хранение чередующееся: системы идут группами по BatchLanes, и внутри группы один и тот же
+// элемент всех систем лежит подряд. Тогда шаг исключения — те же операции, что в обычном
+// Гауссе, только над векторами из BatchLanes систем сразу, без перестановок и масок.
+// Строка g матриц A, B, X — группа g: A[((i * n) + j) * BatchLanes + l], B и X — [i * BatchLanes + l].
+// Последняя группа дополнена системами E x = 0.
+const int BatchLanes = 8;
+
+class SystemBatch {
+public:
+    void Resize(long long count, int n);
+
+    long long Count() const { return count; }
+    int Order() const { return n; }
+    long long Groups() const { return (count + BatchLanes - 1) / BatchLanes; }
+
+    double& A(long long s, int i, int j) { return a.Row(s / BatchLanes)[((size_t)i * n + j) * BatchLanes + s % BatchLanes]; }
+    double& B(long long s, int i) { return b.Row(s / BatchLanes)[(size_t)i * BatchLanes + s % BatchLanes]; }
+    double& X(long long s, int i) { return x.Row(s / BatchLanes)[(size_t)i * BatchLanes + s % BatchLanes]; }
+    double A(long long s, int i, int j) const { return a.Row(s / BatchLanes)[((size_t)i * n + j) * BatchLanes + s % BatchLanes]; }
+    double B(long long s, int i) const { return b.Row(s / BatchLanes)[(size_t)i * BatchLanes + s % BatchLanes]; }
+    double X(long long s, int i) const { return x.Row(s / BatchLanes)[(size_t)i * BatchLanes + s % BatchLanes]; }
+
+    const double* GroupA(long long g) const { return a.Row(g); }
+    const double* GroupB(long long g) const { return b.Row(g); }
+    double* GroupX(long long g) { return x.Row(g); }
+
+private:
+    long long count = 0;
+    int n = 0;
+    Matrix a, b, x;
+};
+
+// batch.bin из папки (формат — gen_main --batch); системы раскладываются по группам при чтении
+void ReadBatch(const std::string& folder, SystemBatch& sys);
+// X в том же формате, что batchXtrue.bin: int64 K, int64 N, затем K раз по N double
+void WriteBatchSolution(const std::string& path, const SystemBatch& sys);
+
+struct BatchStats {
+    long long pivoted = 0;    // решены заново с выбором ведущего элемента
+    long long singular = 0;   // вырождены и с выбором; их X — NaN
+};
+
+// Решение всех систем пакета в threads потоков, группы раздаются порциями.
+// Ядро — по выбранному набору инструкций (KernelName: scalar, avx2, avx512); для порядков
+// из BatchFixedOrder — отдельная версия с порядком, известным при компиляции, у которой
+// циклы развёрнуты целиком. generic = true — всегда общая версия (для сравнения).
+// Гаусс без выбора ведущего элемента, как в движках; система, у которой решение вышло
+// не конечным или какой-то ведущий элемент меньше n * eps * max|a_ij| этой системы,
+// решается заново FactorPivoted.
+BatchStats SolveBatch(SystemBatch& sys, int threads, bool generic = false);
+
+// Есть ли развёрнутая версия ядра для порядка n
+bool BatchFixedOrder(int n);
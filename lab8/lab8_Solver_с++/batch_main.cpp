@@ -0,0 +1,163 @@
+#include <vector>
+#include <string>
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <stdexcept>
+#include "batch.h"
+#include "kernel.h"
+#include "topology.h"
+
+// Пакет малых систем (gen_main --batch): все системы читаются одним процессом из batch.bin,
+// решаются пакетным ядром и пишутся в batchX.bin. Пропускная способность — систем в секунду
+// по лучшему из --repeat прогонов решения; чтение и запись в неё не входят.
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double MsSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+// Худшая по системам обратная ошибка ||A x - b|| / (||A|| ||x|| + ||b||), бесконечная норма
+static double WorstBackwardError(const SystemBatch& sys)
+{
+    const int n = sys.Order();
+    double worst = 0.0;
+    for (long long s = 0; s < sys.Count(); ++s) {
+        double res = 0.0, normA = 0.0, normX = 0.0, normB = 0.0;
+        for (int i = 0; i < n; ++i) {
+            long double r = -(long double)sys.B(s, i);
+            double rowSum = 0.0;
+            for (int j = 0; j < n; ++j) {
+                r += (long double)sys.A(s, i, j) * sys.X(s, j);
+                rowSum += std::abs(sys.A(s, i, j));
+            }
+            if (std::isnan(r)) return NAN;   // вырожденная система: X — NaN
+            res = std::max(res, (double)std::abs(r));
+            normA = std::max(normA, rowSum);
+            normX = std::max(normX, std::abs(sys.X(s, i)));
+            normB = std::max(normB, std::abs(sys.B(s, i)));
+        }
+        double denom = normA * normX + normB;
+        worst = std::max(worst, denom > 0 ? res / denom : res);
+    }
+    return worst;
+}
+
+// max |X - Xtrue| по batchXtrue.bin; отрицательное — файла нет
+static double CompareWithTrue(const std::string& folder, const SystemBatch& sys)
+{
+    std::FILE* f = std::fopen((folder + "/batchXtrue.bin").c_str(), "rb");
+    if (!f) return -1.0;
+    long long header[2];
+    double worst = -1.0;
+    if (std::fread(header, sizeof(header), 1, f) == 1 && header[0] == sys.Count() && header[1] == sys.Order()) {
+        std::vector<double> row(sys.Order());
+        worst = 0.0;
+        for (long long s = 0; s < sys.Count(); ++s) {
+            if (std::fread(row.data(), sizeof(double), row.size(), f) != row.size()) break;
+            for (int i = 0; i < sys.Order(); ++i) worst = std::max(worst, std::abs(sys.X(s, i) - row[i]));
+        }
+    }
+    std::fclose(f);
+    return worst;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cerr << "Ожидался аргумент — путь к папке с batch.bin\n";
+        std::cerr << "Использование: batch_main <папка> [--threads=T] [--kernel=auto|scalar|avx2|avx512] [--generic]\n"
+                  << "                  [--repeat=R] [--verify[=TOL]]\n";
+        return 1;
+    }
+
+    std::string folder;
+    std::vector<CpuInfo> topo = ReadTopology();
+    int threads = PhysicalCores(topo);
+    std::string kernelName = "auto";
+    bool generic = false;
+    int repeat = 3;
+    bool verify = false;
+    double verifyTol = 1e-10;
+    try {
+        for (int a = 1; a < argc; ++a) {
+            std::string arg = argv[a];
+            if (arg.rfind("--threads=", 0) == 0) threads = std::max(1, std::stoi(arg.substr(10)));
+            else if (arg.rfind("--kernel=", 0) == 0) kernelName = arg.substr(9);
+            else if (arg == "--generic") generic = true;
+            else if (arg.rfind("--repeat=", 0) == 0) repeat = std::max(1, std::stoi(arg.substr(9)));
+            else if (arg == "--verify") verify = true;
+            else if (arg.rfind("--verify=", 0) == 0) { verify = true; verifyTol = std::stod(arg.substr(9)); }
+            else if (arg.rfind("--", 0) == 0) throw std::runtime_error("Unknown argument: " + arg);
+            else folder = arg;
+        }
+        SelectKernel(kernelName);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    SystemBatch sys;
+    auto t0 = Clock::now();
+    try {
+        ReadBatch(folder, sys);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    double loadMs = MsSince(t0);
+
+    BatchStats stats;
+    double solveMs = 0.0;
+    for (int r = 0; r < repeat; ++r) {
+        t0 = Clock::now();
+        stats = SolveBatch(sys, threads, generic);
+        double ms = MsSince(t0);
+        solveMs = (r == 0) ? ms : std::min(solveMs, ms);
+    }
+
+    t0 = Clock::now();
+    try {
+        WriteBatchSolution(folder + "/batchX.bin", sys);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    double writeMs = MsSince(t0);
+
+    const int n = sys.Order();
+    const double perSecond = sys.Count() / (solveMs / 1000.0);
+    const bool fixed = !generic && BatchFixedOrder(n);
+    std::cout << "==============================================\n";
+    std::cout << "Систем: " << sys.Count() << ", порядок " << n << ", по " << BatchLanes << " в векторе\n";
+    std::cout << "Ядро: " << KernelName() << (fixed ? ", развёрнутое для n = " + std::to_string(n) : ", общее")
+              << ", потоков: " << threads << "\n";
+    std::cout << "Загрузка: " << loadMs << " мс, решение: " << solveMs << " мс (лучшее из " << repeat << "), запись: "
+              << writeMs << " мс\n";
+    std::cout << "Пропускная способность: " << perSecond << " систем/с, " << solveMs * 1e6 / sys.Count()
+              << " нс на систему\n";
+    if (stats.pivoted > 0)
+        std::cout << "С выбором ведущего элемента: " << stats.pivoted << ", вырождены: " << stats.singular << "\n";
+
+    int code = stats.singular > 0 ? 2 : 0;
+    if (verify) {
+        double err = WorstBackwardError(sys);
+        std::cout << "Обратная ошибка (худшая): " << err << (err <= verifyTol ? " (в пределах " : " (ПРЕВЫШАЕТ ") << verifyTol
+                  << ")\n";
+        double diff = CompareWithTrue(folder, sys);
+        if (diff >= 0) std::cout << "max |X - Xtrue| = " << diff << "\n";
+        if (!(err <= verifyTol)) code = 3;
+    }
+    std::cout << "==============================================\n";
+    std::cout << "TIMINGS engine=batch n=" << n << " systems=" << sys.Count() << " threads=" << threads
+              << " kernel=" << KernelName() << (fixed ? "-fixed" : "") << " load_ms=" << loadMs << " solve_ms=" << solveMs
+              << " write_ms=" << writeMs << " systems_per_s=" << perSecond << "\n";
+    return code;
+}
@@ -0,0 +1,29 @@
+#!/bin/sh
+# До/после для NUMA: исходный режим (без закрепления, страницы касается главный поток,
+# обычные страницы) против закрепления physical/compact/scatter с first-touch и большими страницами.
+# Время разложения берётся из строки TIMINGS, которую печатает solver_main.
+# Использование: ./bench_numa.sh <папка с данными> [потоков] [движок]
+
+DATA=$1
+THREADS=${2:-$(nproc)}
+ENGINE=${3:-threads}
+SOLVER=${SOLVER:-./solver_main}
+
+if [ -z "$DATA" ]; then
+    echo "Использование: $0 <папка с данными> [потоков] [движок]"
+    exit 1
+fi
+
+run() {
+    MS=$($SOLVER "$DATA" --engine="$ENGINE" --threads="$THREADS" "$@" | grep "^TIMINGS" | sed 's/.*factor_ms=\([0-9.]*\).*/\1/')
+    [ -n "$MS" ] || exit 1
+    printf "%s\t%s\n" "$*" "$MS"
+}
+
+printf "options\tfactor_ms\n"
+run --affinity=none
+for A in physical compact scatter; do
+    run --affinity=$A
+    run --affinity=$A --first-touch
+    run --affinity=$A --first-touch --hugepages
+done
@@ -0,0 +1,170 @@
+#include "condition.h"
+#include "engine.h"
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+double NormOne(const Matrix& A)
+{
+    std::vector<double> colSum(A.Cols(), 0.0);
+    for (int i = 0; i < A.Rows(); ++i) {
+        const double* row = A.Row(i);
+        for (int j = 0; j < A.Cols(); ++j) colSum[j] += std::abs(row[j]);
+    }
+    double norm = 0.0;
+    for (double s : colSum) norm = std::max(norm, s);
+    return norm;
+}
+
+double MaxAbs(const Matrix& A)
+{
+    double m = 0.0;
+    for (int i = 0; i < A.Rows(); ++i) {
+        const double* row = A.Row(i);
+        for (int j = 0; j < A.Cols(); ++j) m = std::max(m, std::abs(row[j]));
+    }
+    return m;
+}
+
+double PivotGrowth(const Matrix& LU, double maxA)
+{
+    double maxU = 0.0;
+    for (int i = 0; i < LU.Rows(); ++i) {
+        const double* row = LU.Row(i);
+        for (int j = i; j < LU.Cols(); ++j) maxU = std::max(maxU, std::abs(row[j]));
+    }
+    return maxA > 0 ? maxU / maxA : maxU;
+}
+
+// A^T y = x через A = LU: сначала U^T, потом L^T; обе по строкам LU, без транспонирования
+static void SolveTransposed(const Matrix& LU, std::vector<double>& x)
+{
+    const int n = LU.Rows();
+    for (int k = 0; k < n; ++k) {
+        const double* row = LU.Row(k);
+        double y = x[k] / row[k];
+        x[k] = y;
+        for (int j = k + 1; j < n; ++j) x[j] -= row[j] * y;
+    }
+    for (int k = n - 1; k >= 0; --k) {
+        const double* row = LU.Row(k);
+        double z = x[k];
+        for (int j = 0; j < k; ++j) x[j] -= row[j] * z;
+    }
+}
+
+static double SignOf(double v) { return v >= 0 ? 1.0 : -1.0; }
+
+double EstimateInverseNormOne(const Matrix& LU)
+{
+    const int n = LU.Rows();
+    if (n == 0) return 0.0;
+    Matrix v(n, 1);
+    auto solve = [&]() {
+        SolveLU(LU, v, 1);
+        double s = 0.0;
+        for (int i = 0; i < n; ++i) s += std::abs(v(i, 0));
+        return s;
+    };
+    // z = A^-T * sign(v); возвращает argmax |z_j|
+    std::vector<double> sign(n), z(n);
+    auto gradient = [&]() {
+        for (int i = 0; i < n; ++i) z[i] = sign[i] = SignOf(v(i, 0));
+        SolveTransposed(LU, z);
+        int j = 0;
+        for (int i = 1; i < n; ++i)
+            if (std::abs(z[i]) > std::abs(z[j])) j = i;
+        return j;
+    };
+
+    for (int i = 0; i < n; ++i) v(i, 0) = 1.0 / n;
+    double est = solve();
+    if (n == 1) return est;
+    int j = gradient();
+
+    for (int iter = 2; iter <= 5; ++iter) {
+        for (int i = 0; i < n; ++i) v(i, 0) = (i == j) ? 1.0 : 0.0;
+        double prev = est;
+        est = solve();
+        bool sameSigns = true;
+        for (int i = 0; i < n && sameSigns; ++i) sameSigns = SignOf(v(i, 0)) == sign[i];
+        if (sameSigns || est <= prev) {
+            est = std::max(est, prev);
+            break;
+        }
+        int last = j;
+        j = gradient();
+        if (std::abs(z[last]) == std::abs(z[j])) break;
+    }
+
+    // вектор Хайэма ловит случаи, на которых градиентный поиск застревает
+    for (int i = 0; i < n; ++i) v(i, 0) = ((i % 2) ? -1.0 : 1.0) * (1.0 + (double)i / (n - 1));
+    double alt = 2.0 * solve() / (3.0 * n);
+    return std::max(est, alt);
+}
+
+double BackwardError(const Matrix& A, const Matrix& B, const Matrix& X, Matrix* R)
+{
+    const int n = A.Rows();
+    double normA = 0.0;
+    for (int i = 0; i < n; ++i) {
+        double s = 0.0;
+        for (int j = 0; j < n; ++j) s += std::abs(A(i, j));
+        normA = std::max(normA, s);
+    }
+    if (R) R->Resize(n, B.Cols());
+
+    double worst = 0.0;
+    for (int c = 0; c < B.Cols(); ++c) {
+        double res = 0.0, normX = 0.0, normB = 0.0;
+        for (int i = 0; i < n; ++i) {
+            const double* row = A.Row(i);
+            long double s = -(long double)B(i, c);
+            for (int j = 0; j < n; ++j) s += (long double)row[j] * X(j, c);
+            if (R) (*R)(i, c) = (double)-s;
+            res = std::max(res, (double)std::abs(s));
+            normX = std::max(normX, std::abs(X(i, c)));
+            normB = std::max(normB, std::abs(B(i, c)));
+        }
+        double denom = normA * normX + normB;
+        worst = std::max(worst, denom > 0 ? res / denom : res);
+    }
+    return worst;
+}
+
+void PermuteRows(const std::vector<int>& perm, const Matrix& B, Matrix& X)
+{
+    if (perm.empty()) {
+        X = B;
+        return;
+    }
+    X.Resize(B.Rows(), B.Cols());
+    for (int i = 0; i < B.Rows(); ++i) std::copy(B.Row(perm[i]), B.Row(perm[i]) + B.Cols(), X.Row(i));
+}
+
+RefineResult Refine(const Matrix& A, const Matrix& LU, const std::vector<int>& perm, const Matrix& B, Matrix& X,
+                    int threads, int maxIter)
+{
+    RefineResult res;
+    const double tol = DBL_EPSILON * std::sqrt((double)std::max(1, A.Rows()));
+    Matrix R, D;
+    double prev = HUGE_VAL;
+    for (int it = 0; it <= maxIter; ++it) {
+        double berr = BackwardError(A, B, X, &R);
+        res.iterations = it;
+        res.backwardError = berr;
+        if (!std::isfinite(berr)) return res;
+        if (berr <= tol) {
+            res.converged = true;
+            return res;
+        }
+        if (berr > 0.5 * prev || it == maxIter) return res;
+        prev = berr;
+
+        PermuteRows(perm, R, D);
+        SolveLU(LU, D, threads);
+        for (int i = 0; i < X.Rows(); ++i)
+            for (int c = 0; c < X.Cols(); ++c) X(i, c) += D(i, c);
+    }
+    return res;
+}
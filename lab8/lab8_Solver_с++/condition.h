@@ -0,0 +1,38 @@
+#pragma once
+#include <vector>
+#include "matrix.h"
+
+// Оценки качества разложения без выбора ведущего элемента. Всё — O(n^2) поверх готового LU,
+// то есть дешевле самого разложения в n раз.
+
+double NormOne(const Matrix& A);   // max по столбцам сумма |a_ij|
+double MaxAbs(const Matrix& A);
+
+// Рост элементов max|U| / max|A| (maxA — max|a_ij| исходной матрицы)
+double PivotGrowth(const Matrix& LU, double maxA);
+
+// Оценка ||A^-1||_1 по LU методом Хагера в варианте Хайэма (как LAPACK dlacn2): не больше
+// пяти пар решений с A и A^T, плюс проверочный вектор Хайэма. Перестановка строк (PA = LU)
+// на 1-норму обратной не влияет, так что подходит и LU после FactorPivoted.
+// cond_1(A) ~ NormOne(A) * EstimateInverseNormOne(LU).
+double EstimateInverseNormOne(const Matrix& LU);
+
+// Нормированная обратная ошибка ||A*X - B|| / (||A|| * ||X|| + ||B||) по бесконечной норме,
+// худшая по столбцам; невязка считается в long double. Если R не nullptr, туда пишется B - A*X.
+double BackwardError(const Matrix& A, const Matrix& B, const Matrix& X, Matrix* R = nullptr);
+
+struct RefineResult {
+    bool converged = false;
+    int iterations = 0;
+    double backwardError = 0.0;
+};
+
+// Итерационное уточнение X по исходной A и её разложению LU (perm — из FactorPivoted
+// или пустой): поправка решается тем же LU, невязка — в long double. Останов как в LAPACK
+// dsgesv: обратная ошибка не больше eps * sqrt(n); если ошибка за шаг падает меньше чем
+// вдвое, уточнение прекращается с converged = false.
+RefineResult Refine(const Matrix& A, const Matrix& LU, const std::vector<int>& perm, const Matrix& B, Matrix& X,
+                    int threads, int maxIter = 10);
+
+// X(i) = B(perm[i]); пустая perm — просто копия
+void PermuteRows(const std::vector<int>& perm, const Matrix& B, Matrix& X);
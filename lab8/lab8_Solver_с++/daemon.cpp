@@ -0,0 +1,494 @@
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "matrix.h"
+#include "io.h"
+#include "engine.h"
+#include "kernel.h"
+#include "condition.h"
+#include "topology.h"
+#include "protocol.h"
+#include "tune.h"
+
+// Долгоживущий решатель: матрицы и их LU остаются в памяти между запросами, так что
+// повторное решение с той же A стоит O(n^2) подстановок вместо чтения и разложения.
+// Команды — protocol.h. Команды всех соединений обслуживает общий пул из --workers потоков;
+// решения по одной матрице идут параллельно под разделяемой блокировкой, разложение и
+// UPDATE — под исключительной. Память ограничена --memory: при загрузке новой матрицы
+// вытесняются давно не использованные (LRU); решение, которое уже идёт, держит свою
+// матрицу до конца.
+// Использование: solver_daemon <сокет> [--memory=MB] [--workers=W] [--engine=threads]
+//                [--threads=T] [--kernel=auto|scalar|avx2|avx512] [--profile=PATH] [--no-profile]
+// Параметры движка, не заданные явно, берутся из профиля автонастройки (tune.h) под порядок
+// каждой матрицы.
+
+typedef std::chrono::steady_clock Clock;
+
+static double MsSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+struct Entry {
+    std::shared_mutex lock;
+    Matrix A;                 // исходная, для UPDATE и запасного разложения
+    Matrix LU;
+    std::vector<int> perm;    // не пуста, если пришлось раскладывать с выбором ведущего элемента
+    bool factored = false;
+    size_t Bytes() const { return 2 * A.Bytes(); }   // A и LU того же размера
+};
+
+// Ошибка, после которой неизвестно, где в потоке начинается следующая команда (данные
+// команды не дочитаны): ответ ERR, затем соединение закрывается
+struct StreamLost : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+// LRU по именам; used считает A и LU каждой матрицы сразу, даже если она ещё не разложена
+class Store {
+public:
+    explicit Store(size_t capacity) : capacity(capacity) {}
+
+    std::shared_ptr<Entry> Get(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(m);
+        auto it = entries.find(name);
+        if (it == entries.end()) {
+            ++misses;
+            return nullptr;
+        }
+        ++hits;
+        order.splice(order.begin(), order, it->second.pos);
+        return it->second.entry;
+    }
+
+    // Матрица больше всего --memory не вытесняет ничего: хранить её всё равно нельзя
+    void Put(const std::string& name, std::shared_ptr<Entry> entry)
+    {
+        std::lock_guard<std::mutex> lock(m);
+        if (entry->Bytes() > capacity) {
+            std::ostringstream why;
+            why << name << " needs " << entry->Bytes() / (1024.0 * 1024.0) << " MB with LU, --memory is "
+                << capacity / (1024.0 * 1024.0) << " MB";
+            throw std::runtime_error(why.str());
+        }
+        Remove(name);
+        while (!order.empty() && used + entry->Bytes() > capacity) {
+            Remove(order.back());
+            ++evictions;
+        }
+        order.push_front(name);
+        entries[name] = { entry, order.begin() };
+        used += entry->Bytes();
+    }
+
+    bool Drop(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(m);
+        return Remove(name);
+    }
+
+    std::string Stats()
+    {
+        std::lock_guard<std::mutex> lock(m);
+        std::ostringstream out;
+        out << "entries=" << entries.size() << " mb=" << used / (1024.0 * 1024.0) << " capacity_mb="
+            << capacity / (1024.0 * 1024.0) << " hits=" << hits << " misses=" << misses << " evictions=" << evictions;
+        return out.str();
+    }
+
+private:
+    struct Slot {
+        std::shared_ptr<Entry> entry;
+        std::list<std::string>::iterator pos;
+    };
+
+    bool Remove(const std::string& name)
+    {
+        auto it = entries.find(name);
+        if (it == entries.end()) return false;
+        used -= it->second.entry->Bytes();
+        order.erase(it->second.pos);
+        entries.erase(it);
+        return true;
+    }
+
+    std::mutex m;
+    size_t capacity;
+    size_t used = 0;
+    std::list<std::string> order;   // в начале — последняя использованная
+    std::unordered_map<std::string, Slot> entries;
+    long long hits = 0, misses = 0, evictions = 0;
+};
+
+class Daemon {
+public:
+    Daemon(const std::string& engineName, const EngineOptions& opt, size_t memory, int workers)
+        : engineName(engineName), opt(opt), store(memory), numWorkers(std::max(1, workers))
+    {
+        MakeEngine(engineName, opt);   // неизвестное имя движка — ошибка сразу при запуске
+    }
+
+    void UseProfile(const TuneProfile& p, unsigned keepOptions)
+    {
+        profile = p;
+        haveProfile = true;
+        keep = keepOptions;
+    }
+
+    // Главный поток ждёт в poll на сокете демона и на простаивающих соединениях; соединение,
+    // в котором пришла команда, уходит в очередь пула и возвращается в poll после ответа.
+    // Так несколько обработчиков обслуживают любое число клиентов.
+    void Run(const std::string& socketPath)
+    {
+        listenFd = ListenUnix(socketPath);
+        if (::pipe(wakeFds) != 0) throw std::runtime_error("Cannot create pipe");
+        std::vector<std::thread> pool;
+        for (int t = 0; t < numWorkers; ++t) pool.emplace_back(&Daemon::WorkerRoutine, this);
+
+        std::vector<std::unique_ptr<LineSocket>> idle;
+        std::vector<pollfd> fds;
+        while (!stopping) {
+            fds.assign(2, pollfd());
+            fds[0] = { listenFd, POLLIN, 0 };
+            fds[1] = { wakeFds[0], POLLIN, 0 };
+            for (auto& c : idle) fds.push_back({ c->Fd(), POLLIN, 0 });
+            if (::poll(fds.data(), fds.size(), -1) < 0) continue;
+
+            std::vector<std::unique_ptr<LineSocket>> still;
+            for (size_t i = 0; i < idle.size(); ++i) {
+                if (fds[i + 2].revents) Submit(std::move(idle[i]));
+                else still.push_back(std::move(idle[i]));
+            }
+            idle.swap(still);
+            if (fds[1].revents) {
+                char drain[64];
+                (void)::read(wakeFds[0], drain, sizeof(drain));
+                std::lock_guard<std::mutex> lock(m);
+                for (auto& c : returned) idle.push_back(std::move(c));
+                returned.clear();
+            }
+            if (fds[0].revents) {
+                int fd = ::accept(listenFd, nullptr, nullptr);
+                if (fd >= 0) idle.emplace_back(new LineSocket(fd));
+            }
+        }
+
+        idle.clear();
+        {
+            std::lock_guard<std::mutex> lock(m);
+            pending.clear();
+            returned.clear();
+        }
+        cv.notify_all();
+        for (auto& th : pool) th.join();
+        returned.clear();
+        ::close(wakeFds[0]);
+        ::close(wakeFds[1]);
+        ::close(listenFd);
+        ::unlink(socketPath.c_str());
+    }
+
+private:
+    void Submit(std::unique_ptr<LineSocket> conn)
+    {
+        std::lock_guard<std::mutex> lock(m);
+        pending.push_back(std::move(conn));
+        cv.notify_one();
+    }
+
+    // Соединение возвращается главному потоку; закрытое просто уничтожается
+    void Return(std::unique_ptr<LineSocket> conn)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            returned.push_back(std::move(conn));
+        }
+        Wake();
+    }
+
+    void Wake()
+    {
+        char c = 0;
+        (void)::write(wakeFds[1], &c, 1);
+    }
+
+    void WorkerRoutine()
+    {
+        while (true) {
+            std::unique_ptr<LineSocket> conn;
+            {
+                std::unique_lock<std::mutex> lock(m);
+                cv.wait(lock, [this] { return !pending.empty() || stopping; });
+                if (stopping) return;
+                conn = std::move(pending.front());
+                pending.pop_front();
+            }
+            // команды, пришедшие одним пакетом, обрабатываются подряд без возврата в poll
+            bool open;
+            do open = ServeOne(*conn);
+            while (open && conn->HasLine() && !stopping);
+            if (open && !stopping) Return(std::move(conn));
+        }
+    }
+
+    // Одна команда и ответ на неё; false — соединение закрыто
+    bool ServeOne(LineSocket& sock)
+    {
+        std::string line;
+        if (!sock.ReadLine(line)) return false;
+        std::string reply;
+        bool keepOpen = true;
+        try {
+            reply = Handle(sock, line);
+        }
+        catch (const StreamLost& e) {
+            reply = std::string("ERR ") + e.what() + "\n";
+            keepOpen = false;
+        }
+        catch (const std::exception& e) {
+            reply = std::string("ERR ") + e.what() + "\n";
+        }
+        try {
+            sock.WriteAll(reply);
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+        return keepOpen;
+    }
+
+    std::shared_ptr<Entry> Find(const std::string& name)
+    {
+        std::shared_ptr<Entry> e = store.Get(name);
+        if (!e) throw std::runtime_error("No matrix named " + name + " (LOAD it first)");
+        return e;
+    }
+
+    // Разложение под исключительной блокировкой; без выбора ведущего элемента не вышло —
+    // раскладывается заново с выбором (FactorPivoted)
+    static void FactorLocked(Entry& e, const std::string& engineName, const EngineOptions& opt, bool& pivoted)
+    {
+        e.LU = e.A;
+        e.perm.clear();
+        pivoted = false;
+        try {
+            MakeEngine(engineName, opt)->Factor(e.LU);
+        }
+        catch (const std::exception&) {
+            e.LU = e.A;
+            FactorPivoted(e.LU, e.perm);
+            pivoted = true;
+        }
+        e.factored = true;
+    }
+
+    // Разложение, если его ещё нет; возвращает время, потраченное на него
+    double EnsureFactored(Entry& e, bool* pivotedOut = nullptr)
+    {
+        std::unique_lock<std::shared_mutex> lock(e.lock);
+        if (e.factored) return 0.0;
+        auto t0 = Clock::now();
+        bool pivoted = false;
+        EngineOptions o = opt;
+        std::string tuned;
+        if (haveProfile) profile.Apply(engineName, e.A.Rows(), o, keep, tuned);
+        FactorLocked(e, engineName, o, pivoted);
+        if (pivotedOut) *pivotedOut = pivoted;
+        return MsSince(t0);
+    }
+
+    // Решение под разделяемой блокировкой; если между разложением и решением пришёл UPDATE,
+    // матрица раскладывается снова
+    void Solve(Entry& e, const Matrix& B, Matrix& X, double& factorMs)
+    {
+        factorMs = 0;
+        while (true) {
+            factorMs += EnsureFactored(e);
+            std::shared_lock<std::shared_mutex> lock(e.lock);
+            if (!e.factored) continue;
+            if (B.Rows() != e.LU.Rows()) throw std::runtime_error("B has " + std::to_string(B.Rows()) + " rows, A is " + std::to_string(e.LU.Rows()));
+            PermuteRows(e.perm, B, X);
+            SolveLU(e.LU, X, 1);
+            return;
+        }
+    }
+
+    std::string Handle(LineSocket& sock, const std::string& line)
+    {
+        std::istringstream in(line);
+        std::string cmd, name;
+        in >> cmd >> name;
+        std::ostringstream out;
+
+        if (cmd == "LOAD") {
+            std::string folder, mode;
+            in >> folder >> mode;
+            auto t0 = Clock::now();
+            auto e = std::make_shared<Entry>();
+            Matrix B;
+            ReadSystem(folder, e->A, B, mode == "text");
+            store.Put(name, e);
+            out << "OK n=" << e->A.Rows() << " m=" << B.Cols() << " load_ms=" << MsSince(t0) << "\n";
+        }
+        else if (cmd == "FACTOR") {
+            bool pivoted = false;
+            double ms = EnsureFactored(*Find(name), &pivoted);
+            out << "OK factor_ms=" << ms << (pivoted ? " pivoted" : "") << "\n";
+        }
+        else if (cmd == "SOLVE") {
+            // сколько строк B идёт следом, известно только по самой матрице: без неё или
+            // при оборванной B пропустить остаток нельзя
+            int m = 0;
+            in >> m;
+            std::shared_ptr<Entry> e;
+            Matrix B, X;
+            try {
+                if (m <= 0) throw std::runtime_error("SOLVE <name> <m>: m must be positive");
+                e = Find(name);
+                int n;
+                {
+                    std::shared_lock<std::shared_mutex> lock(e->lock);
+                    n = e->A.Rows();
+                }
+                sock.ReadMatrix(B, n, m);
+            }
+            catch (const std::exception& ex) {
+                throw StreamLost(ex.what());
+            }
+            auto t0 = Clock::now();
+            double factorMs;
+            Solve(*e, B, X, factorMs);
+            out << "OK solve_ms=" << MsSince(t0) - factorMs << " factor_ms=" << factorMs << "\n";
+            std::string reply = out.str();
+            AppendMatrix(reply, X);
+            return reply;
+        }
+        else if (cmd == "SOLVEFILE") {
+            std::string folder;
+            in >> folder;
+            auto e = Find(name);
+            Matrix B, X;
+            ReadRightHandSides(folder, e->A.Rows(), B);
+            auto t0 = Clock::now();
+            double factorMs;
+            Solve(*e, B, X, factorMs);
+            double solveMs = MsSince(t0) - factorMs;
+            WriteSolution(folder + "/X.txt", X);
+            out << "OK solve_ms=" << solveMs << " factor_ms=" << factorMs << "\n";
+        }
+        else if (cmd == "UPDATE") {
+            int i = -1;
+            in >> i;
+            // строка данных дочитывается до любых проверок: ошибка не сбивает поток команд
+            std::string payload;
+            if (!sock.ReadLine(payload)) throw StreamLost("Connection closed");
+            auto e = Find(name);
+            std::vector<double> row;
+            const char* p = payload.data();
+            ParseLine(p, p + payload.size(), row);
+            std::unique_lock<std::shared_mutex> lock(e->lock);
+            const int n = e->A.Rows();
+            if ((int)row.size() != n) throw std::runtime_error("Expected " + std::to_string(n) + " numbers in row");
+            if (i < 0 || i >= n) throw std::runtime_error("UPDATE: row index out of range");
+            std::copy(row.begin(), row.end(), e->A.Row(i));
+            e->factored = false;
+            out << "OK\n";
+        }
+        else if (cmd == "DROP") {
+            if (!store.Drop(name)) throw std::runtime_error("No matrix named " + name);
+            out << "OK\n";
+        }
+        else if (cmd == "STATS") {
+            out << "OK " << store.Stats() << "\n";
+        }
+        else if (cmd == "SHUTDOWN") {
+            stopping = true;
+            Wake();
+            out << "OK\n";
+        }
+        else throw std::runtime_error("Unknown command: " + cmd);
+        return out.str();
+    }
+
+    std::string engineName;
+    EngineOptions opt;
+    TuneProfile profile;
+    bool haveProfile = false;
+    unsigned keep = 0;
+    Store store;
+    int numWorkers;
+
+    int listenFd = -1;
+    int wakeFds[2] = { -1, -1 };   // будит poll главного потока
+    std::atomic<bool> stopping{ false };
+    std::mutex m;
+    std::condition_variable cv;
+    std::deque<std::unique_ptr<LineSocket>> pending;          // соединения с командой, ждут обработчика
+    std::vector<std::unique_ptr<LineSocket>> returned;        // обслуженные, ждут возврата в poll
+};
+
+int main(int argc, char* argv[])
+{
+    std::string socketPath;
+    std::string engineName = "threads";
+    std::string kernelName = "auto";
+    EngineOptions opt;
+    std::vector<CpuInfo> topo = ReadTopology();
+    opt.threads = PhysicalCores(topo);
+    int workers = PhysicalCores(topo);
+    long memoryMb = 1024;
+    std::string profilePath = DefaultProfilePath();
+    bool useProfile = true;
+    unsigned keep = 0;
+    try {
+        for (int a = 1; a < argc; ++a) {
+            std::string arg = argv[a];
+            if (arg.rfind("--engine=", 0) == 0) engineName = arg.substr(9);
+            else if (arg.rfind("--threads=", 0) == 0) { opt.threads = std::max(1, std::stoi(arg.substr(10))); keep |= KeepThreads; }
+            else if (arg.rfind("--profile=", 0) == 0) profilePath = arg.substr(10);
+            else if (arg == "--no-profile") useProfile = false;
+            else if (arg.rfind("--workers=", 0) == 0) workers = std::max(1, std::stoi(arg.substr(10)));
+            else if (arg.rfind("--memory=", 0) == 0) memoryMb = std::max(1L, std::stol(arg.substr(9)));
+            else if (arg.rfind("--kernel=", 0) == 0) kernelName = arg.substr(9);
+            else if (arg.rfind("--", 0) == 0) throw std::runtime_error("Unknown argument: " + arg);
+            else socketPath = arg;
+        }
+        if (socketPath.empty()) throw std::runtime_error("Ожидался аргумент — путь к сокету");
+        if (engineName == "mpi") throw std::runtime_error("solver_daemon: движок mpi не поддерживается");
+        SelectKernel(kernelName);
+
+        Daemon daemon(engineName, opt, (size_t)memoryMb << 20, workers);
+        TuneProfile profile;
+        std::string why;
+        const bool tuned = useProfile && TunableEngine(engineName) && profile.Load(profilePath, why);
+        if (tuned) daemon.UseProfile(profile, keep);
+        std::cout << "solver_daemon: сокет " << socketPath << ", движок " << engineName << " (потоков " << opt.threads
+                  << "), обработчиков " << workers << ", память " << memoryMb << " МБ"
+                  << (tuned ? ", профиль " + profilePath : std::string()) << std::endl;
+        daemon.Run(socketPath);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        std::cerr << "Использование: solver_daemon <сокет> [--memory=MB] [--workers=W] [--engine=threads] [--threads=T]\n"
+                  << "                     [--kernel=auto|scalar|avx2|avx512] [--profile=PATH] [--no-profile]\n";
+        return 1;
+    }
+    return 0;
+}
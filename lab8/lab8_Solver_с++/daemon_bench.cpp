@@ -0,0 +1,200 @@
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <fstream>
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "matrix.h"
+#include "io.h"
+#include "protocol.h"
+
+// Нагрузка на solver_daemon: LOAD и FACTOR один раз, затем --requests решений SOLVE с B.txt
+// из папки для каждого числа одновременных клиентов из --clients; у каждого клиента своё
+// соединение. Печатает задержку (p50/p95/p99) и пропускную способность и сравнивает с
+// холодным запуском — чтением и разложением, которые без демона оплачивает каждый вызов.
+// Использование: daemon_bench <сокет> <папка> [--clients=1,2,4] [--requests=200]
+//                [--spawn=./solver_daemon] [--name=bench]
+
+typedef std::chrono::steady_clock Clock;
+
+static double MsSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+// Значение из ответа "OK ключ=значение ..."
+static double Field(const std::string& reply, const std::string& key)
+{
+    size_t p = reply.find(" " + key + "=");
+    if (p == std::string::npos) return 0.0;
+    return std::stod(reply.substr(p + key.size() + 2));
+}
+
+static std::string Request(LineSocket& sock, const std::string& request)
+{
+    sock.WriteAll(request);
+    std::string reply;
+    if (!sock.ReadLine(reply)) throw std::runtime_error("solver_daemon closed the connection");
+    if (reply.rfind("OK", 0) != 0) throw std::runtime_error("solver_daemon: " + reply);
+    return reply;
+}
+
+static double Percentile(std::vector<double>& v, double q)
+{
+    if (v.empty()) return 0.0;
+    size_t k = std::min(v.size() - 1, (size_t)std::ceil(q * v.size()) - 1);
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+static std::vector<int> ParseList(const std::string& s)
+{
+    std::vector<int> out;
+    std::istringstream in(s);
+    std::string item;
+    while (std::getline(in, item, ',')) out.push_back(std::max(1, std::stoi(item)));
+    return out;
+}
+
+// Демон запускается отдельным процессом; ждём, пока сокет начнёт принимать соединения
+static pid_t Spawn(const std::string& program, const std::string& socketPath)
+{
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        ::execl(program.c_str(), program.c_str(), socketPath.c_str(), (char*)nullptr);
+        std::cerr << "Cannot start " << program << "\n";
+        ::_exit(127);
+    }
+    for (int attempt = 0; attempt < 200; ++attempt) {
+        try {
+            ::close(ConnectUnix(socketPath));
+            return pid;
+        }
+        catch (const std::exception&) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(25));
+        }
+    }
+    throw std::runtime_error("solver_daemon did not start on " + socketPath);
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> positional;
+    std::vector<int> clientCounts = { 1, 2, 4 };
+    int requests = 200;
+    std::string spawn;
+    std::string name = "bench";
+    pid_t child = -1;
+    try {
+        for (int a = 1; a < argc; ++a) {
+            std::string arg = argv[a];
+            if (arg.rfind("--clients=", 0) == 0) clientCounts = ParseList(arg.substr(10));
+            else if (arg.rfind("--requests=", 0) == 0) requests = std::max(1, std::stoi(arg.substr(11)));
+            else if (arg.rfind("--spawn=", 0) == 0) spawn = arg.substr(8);
+            else if (arg.rfind("--name=", 0) == 0) name = arg.substr(7);
+            else if (arg.rfind("--", 0) == 0) throw std::runtime_error("Unknown argument: " + arg);
+            else positional.push_back(arg);
+        }
+        if (positional.size() != 2) throw std::runtime_error("Ожидались аргументы <сокет> <папка>");
+        const std::string socketPath = positional[0], folder = positional[1];
+        if (!spawn.empty()) child = Spawn(spawn, socketPath);
+
+        LineSocket control(ConnectUnix(socketPath));
+        std::string reply = Request(control, "LOAD " + name + " " + folder + "\n");
+        const int n = (int)Field(reply, "n");
+        const double loadMs = Field(reply, "load_ms");
+        const double factorMs = Field(Request(control, "FACTOR " + name + "\n"), "factor_ms");
+
+        Matrix B;
+        ReadRightHandSides(folder, n, B);
+        std::string solve = "SOLVE " + name + " " + std::to_string(B.Cols()) + "\n";
+        AppendMatrix(solve, B);
+
+        // первое решение — для проверки по Xtrue.txt, если он есть
+        Matrix X;
+        reply = Request(control, solve);
+        control.ReadMatrix(X, n, B.Cols());
+        std::ifstream xtrue(folder + "/Xtrue.txt");
+        if (xtrue) {
+            Matrix T;
+            std::stringstream text;
+            text << xtrue.rdbuf();
+            std::string s = text.str();
+            std::vector<double> row;
+            const char* p = s.data();
+            const char* end = p + s.size();
+            T.Resize(n, B.Cols());
+            for (int i = 0; i < n && p < end; ++i) {
+                ParseLine(p, end, row);
+                std::copy(row.begin(), row.begin() + std::min<size_t>(row.size(), B.Cols()), T.Row(i));
+            }
+            double err = 0.0;
+            for (int i = 0; i < n; ++i)
+                for (int c = 0; c < B.Cols(); ++c) err = std::max(err, std::abs(X(i, c) - T(i, c)));
+            std::cout << "max |X - Xtrue| = " << err << "\n";
+        }
+
+        std::cout << "n = " << n << ", m = " << B.Cols() << "; холодный запуск: чтение " << std::fixed << std::setprecision(3)
+                  << loadMs << " ms + разложение " << factorMs << " ms = " << loadMs + factorMs << " ms\n";
+        std::cout << "clients  requests      req/s    p50 ms    p95 ms    p99 ms    max ms\n";
+        for (int clients : clientCounts) {
+            std::vector<std::vector<double>> latency(clients);
+            std::vector<std::string> errors(clients);
+            std::vector<std::thread> pool;
+            auto t0 = Clock::now();
+            for (int c = 0; c < clients; ++c)
+                pool.emplace_back([&, c]() {
+                    try {
+                        LineSocket sock(ConnectUnix(socketPath));
+                        Matrix Y;
+                        for (int r = c; r < requests; r += clients) {
+                            auto s0 = Clock::now();
+                            Request(sock, solve);
+                            sock.ReadMatrix(Y, n, B.Cols());
+                            latency[c].push_back(MsSince(s0));
+                        }
+                    }
+                    catch (const std::exception& e) {
+                        errors[c] = e.what();
+                    }
+                });
+            for (auto& th : pool) th.join();
+            double wallMs = MsSince(t0);
+            for (const std::string& e : errors)
+                if (!e.empty()) throw std::runtime_error(e);
+
+            std::vector<double> all;
+            for (auto& v : latency) all.insert(all.end(), v.begin(), v.end());
+            double worst = *std::max_element(all.begin(), all.end());
+            std::cout << std::setw(7) << clients << std::setw(10) << all.size() << std::setw(11) << std::setprecision(1)
+                      << all.size() * 1000.0 / wallMs << std::setprecision(3) << std::setw(10) << Percentile(all, 0.50)
+                      << std::setw(10) << Percentile(all, 0.95) << std::setw(10) << Percentile(all, 0.99) << std::setw(10)
+                      << worst << "\n";
+        }
+        std::cout << Request(control, "STATS\n") << "\n";
+
+        if (child > 0) {
+            Request(control, "SHUTDOWN\n");
+            ::waitpid(child, nullptr, 0);
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        std::cerr << "Использование: daemon_bench <сокет> <папка> [--clients=1,2,4] [--requests=200]\n"
+                  << "                    [--spawn=./solver_daemon] [--name=bench]\n";
+        if (child > 0) {
+            ::kill(child, SIGTERM);
+            ::waitpid(child, nullptr, 0);
+        }
+        return 1;
+    }
+    return 0;
+}
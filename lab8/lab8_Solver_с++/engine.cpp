@@ -0,0 +1,249 @@
+#include "engine.h"
+#include "trace.h"
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <system_error>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <sstream>
+
+std::string PivotLimits::Message(double akk, int k) const
+{
+    std::ostringstream out;
+    double a = std::fabs(akk);
+    if (a == 0.0) out << "Нулевой ведущий элемент в строке " << k;
+    else if (a > growth) out << "Рост элементов: |a_kk| = " << a << " в строке " << k << " больше " << growth;
+    else out << "Ведущий элемент |a_kk| = " << a << " в строке " << k << " не больше допуска " << tol;
+    return out.str();
+}
+
+std::unique_ptr<Engine> MakeEngine(const std::string& name, const EngineOptions& opt)
+{
+    if (name == "serial") return MakeSerialEngine(opt);
+    if (name == "threads") return MakeThreadsEngine(opt);
+    if (name == "tiled") return MakeTiledEngine(opt);
+    if (name == "stream") return MakeStreamEngine(opt);
+    if (name == "mpi") return MakeMpiEngine(opt);
+    throw std::runtime_error("Unknown --engine value: " + name);
+}
+
+void Engine::FirstTouch(Matrix& A)
+{
+    std::memset(A.Data(), 0, A.Bytes());
+}
+
+// Подстановки для столбцов [c0, c1) правых частей: строка x_i обновляется
+// строками уже найденных x_j целиком, внутренний цикл идёт подряд по памяти
+static void SolveColumns(const Matrix& LU, Matrix& R, int c0, int c1)
+{
+    TraceScope scope("substitution", c0);
+    const int n = LU.Rows();
+
+    for (int i = 0; i < n; ++i) {
+        const double* row = LU.Row(i);
+        double* ri = R.Row(i);
+        for (int j = 0; j < i; ++j) {
+            double l = row[j];
+            if (l == 0.0) continue;
+            const double* rj = R.Row(j);
+            for (int c = c0; c < c1; ++c) ri[c] -= l * rj[c];
+        }
+    }
+
+    for (int i = n - 1; i >= 0; --i) {
+        const double* row = LU.Row(i);
+        double* ri = R.Row(i);
+        for (int j = i + 1; j < n; ++j) {
+            double u = row[j];
+            if (u == 0.0) continue;
+            const double* rj = R.Row(j);
+            for (int c = c0; c < c1; ++c) ri[c] -= u * rj[c];
+        }
+        double d = row[i];
+        for (int c = c0; c < c1; ++c) ri[c] /= d;
+    }
+}
+
+// Одна правая часть: скалярные произведения строк L и U на уже найденную часть x,
+// четыре независимых накопителя, чтобы сложения не ждали друг друга
+static double Dot(const double* __restrict a, const double* __restrict x, int len)
+{
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    int j = 0;
+    for (; j + 4 <= len; j += 4) {
+        s0 += a[j] * x[j];
+        s1 += a[j + 1] * x[j + 1];
+        s2 += a[j + 2] * x[j + 2];
+        s3 += a[j + 3] * x[j + 3];
+    }
+    for (; j < len; ++j) s0 += a[j] * x[j];
+    return (s0 + s1) + (s2 + s3);
+}
+
+static void SolveSingle(const Matrix& LU, Matrix& R)
+{
+    TraceScope scope("substitution");
+    const int n = LU.Rows();
+    std::vector<double> x(n);
+    for (int i = 0; i < n; ++i) x[i] = R(i, 0);
+
+    for (int i = 0; i < n; ++i)
+        x[i] -= Dot(LU.Row(i), x.data(), i);
+    for (int i = n - 1; i >= 0; --i) {
+        const double* row = LU.Row(i);
+        x[i] = (x[i] - Dot(row + i + 1, x.data() + i + 1, n - i - 1)) / row[i];
+    }
+
+    for (int i = 0; i < n; ++i) R(i, 0) = x[i];
+}
+
+// Блок строк подстановок по строкам
+static const int SolveBlock = 64;
+
+// Барьер на заданное число участников; число задаётся до того, как кто-то его ждёт
+class StepBarrier {
+public:
+    void SetCount(int c) { count = c; }
+    void Wait()
+    {
+        std::unique_lock<std::mutex> lock(m);
+        const long gen = generation;
+        if (++arrived == count) {
+            arrived = 0;
+            ++generation;
+            cv.notify_all();
+            return;
+        }
+        cv.wait(lock, [&] { return generation != gen; });
+    }
+
+private:
+    std::mutex m;
+    std::condition_variable cv;
+    int count = 1, arrived = 0;
+    long generation = 0;
+};
+
+// Правых частей меньше, чем потоков: делить между потоками столбцы нечего, и делятся
+// строки. Подстановки идут блоками по SolveBlock строк: вклад уже найденных блоков в
+// строки текущего считают все потоки, каждый свою часть строк, диагональный блок решает
+// поток 0; шаги разделены барьером. Одна правая часть копируется в сплошной вектор.
+static void SolveRows(const Matrix& LU, Matrix& R, int threads)
+{
+    const int n = LU.Rows(), m = R.Cols();
+    std::vector<double> x;
+    if (m == 1) {
+        x.resize(n);
+        for (int i = 0; i < n; ++i) x[i] = R(i, 0);
+    }
+
+    // x_i -= LU(i, [j0, j1)) * x([j0, j1))
+    auto update = [&](int i, int j0, int j1) {
+        const double* row = LU.Row(i);
+        if (m == 1) {
+            x[i] -= Dot(row + j0, x.data() + j0, j1 - j0);
+            return;
+        }
+        double* ri = R.Row(i);
+        for (int j = j0; j < j1; ++j) {
+            const double l = row[j];
+            if (l == 0.0) continue;
+            const double* rj = R.Row(j);
+            for (int c = 0; c < m; ++c) ri[c] -= l * rj[c];
+        }
+    };
+    auto divide = [&](int i) {
+        const double d = LU.Row(i)[i];
+        if (m == 1) x[i] /= d;
+        else
+            for (int c = 0; c < m; ++c) R.Row(i)[c] /= d;
+    };
+
+    // потоки ждут, пока запустятся все: только тогда известно, сколько их
+    std::mutex gateMutex;
+    std::condition_variable gateCv;
+    int participants = 0;
+    StepBarrier barrier;
+
+    auto body = [&](int id) {
+        {
+            std::unique_lock<std::mutex> lock(gateMutex);
+            gateCv.wait(lock, [&] { return participants > 0; });
+        }
+        TraceScope scope("substitution", id);
+        const int p = participants;
+        auto myRows = [&](int I0, int I1, int& r0, int& r1) {
+            const int per = (I1 - I0 + p - 1) / p;
+            r0 = std::min(I0 + id * per, I1);
+            r1 = std::min(r0 + per, I1);
+        };
+
+        for (int I0 = 0; I0 < n; I0 += SolveBlock) {
+            int I1 = std::min(I0 + SolveBlock, n), r0, r1;
+            myRows(I0, I1, r0, r1);
+            for (int i = r0; i < r1; ++i) update(i, 0, I0);
+            barrier.Wait();
+            if (id == 0)
+                for (int i = I0; i < I1; ++i) update(i, I0, i);
+            barrier.Wait();
+        }
+        for (int I1 = n; I1 > 0; I1 -= SolveBlock) {
+            int I0 = std::max(I1 - SolveBlock, 0), r0, r1;
+            myRows(I0, I1, r0, r1);
+            for (int i = r0; i < r1; ++i) update(i, I1, n);
+            barrier.Wait();
+            if (id == 0)
+                for (int i = I1 - 1; i >= I0; --i) {
+                    update(i, i + 1, I1);
+                    divide(i);
+                }
+            barrier.Wait();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    try {
+        for (int t = 1; t < threads; ++t) pool.emplace_back(body, t);
+    }
+    catch (const std::system_error&) {
+        // поток не создался — считают те, что уже запущены
+    }
+    {
+        std::lock_guard<std::mutex> lock(gateMutex);
+        barrier.SetCount((int)pool.size() + 1);
+        participants = (int)pool.size() + 1;
+    }
+    gateCv.notify_all();
+    body(0);
+    for (auto& th : pool) th.join();
+
+    if (m == 1)
+        for (int i = 0; i < n; ++i) R(i, 0) = x[i];
+}
+
+void SolveLU(const Matrix& LU, Matrix& R, int threads)
+{
+    const int m = R.Cols();
+    threads = std::max(1, threads);
+    if (m < threads && LU.Rows() >= 2 * SolveBlock) {
+        SolveRows(LU, R, threads);
+        return;
+    }
+    if (m == 1) {
+        SolveSingle(LU, R);
+        return;
+    }
+
+    threads = std::min(threads, m);
+    std::vector<std::thread> pool;
+    int per = (m + threads - 1) / threads;
+    for (int t = 1; t < threads; ++t) {
+        int c0 = std::min(t * per, m), c1 = std::min(c0 + per, m);
+        if (c0 < c1) pool.emplace_back(SolveColumns, std::cref(LU), std::ref(R), c0, c1);
+    }
+    SolveColumns(LU, R, 0, std::min(per, m));
+    for (auto& th : pool) th.join();
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+#include "matrix.h"
+
+// Границы для ведущих элементов, проверяемые прямо во время исключения: |a_kk| <= tol —
+// шаг вырожден, |a_kk| > growth — элементы выросли настолько, что ответ бессмыслен.
+// Разложение останавливается на таком шаге, не досчитывая остальные. По умолчанию
+// останавливает только нулевой (или nan) ведущий элемент.
+struct PivotLimits {
+    double tol = 0.0;
+    double growth = HUGE_VAL;
+    bool Bad(double akk) const
+    {
+        double a = std::fabs(akk);
+        return !(a > tol) || a > growth;
+    }
+    // Текст исключения для шага k
+    std::string Message(double akk, int k) const;
+};
+
+// Параметры, общие для всех движков; каждый берёт только то, что ему нужно
+struct EngineOptions {
+    int threads = 1;
+    std::string dist = "cyclic";   // threads: block | cyclic | dynamic
+    int block = 8;                 // threads: порция строк; mpi: блок 2D блочно-циклического распределения
+    int tile = 128;                // tiled: размер плитки
+    std::string affinity = "none"; // threads, tiled: none | physical | compact | scatter (topology.h)
+    int queueRows = 64;            // stream: сколько прочитанных строк может ждать исключения
+    PivotLimits pivot;             // все движки
+};
+
+// Движок раскладывает A на месте в L и U без выбора ведущего элемента:
+// под диагональю множители L (единичная диагональ не хранится), на и над ней — U.
+// Ведущий элемент за границами opt.pivot — исключение. Подстановки общие — SolveLU.
+class Engine {
+public:
+    virtual ~Engine() = default;
+    virtual const char* Name() const = 0;
+    virtual void Factor(Matrix& A) = 0;
+    // Первое касание свежевыделенной матрицы (см. MemoryOptions): по умолчанию обнуляет
+    // вызывающий поток, многопоточные движки — теми потоками и на тех CPU, что будут считать строки
+    virtual void FirstTouch(Matrix& A);
+    // Движок, совмещающий чтение с разложением, сам читает систему из folder (как ReadSystem)
+    // и раскладывает A; loadMs — когда закончилось чтение A и B. Ошибка входных данных —
+    // std::invalid_argument, ошибка разложения — другое исключение. false — движок так
+    // не умеет, и вызывающий читает и раскладывает сам.
+    virtual bool ReadAndFactor(const std::string& folder, Matrix& A, Matrix& B, bool preferText,
+                               const MemoryOptions& mem, double& loadMs)
+    {
+        (void)folder, (void)A, (void)B, (void)preferText, (void)mem, (void)loadMs;
+        return false;
+    }
+    // Строка для отчёта: краж задач, решётка процессов и т.п.
+    virtual std::string Details() const { return std::string(); }
+    // Сколько процессов участвует в разложении (для строки TIMINGS)
+    virtual int Procs() const { return 1; }
+};
+
+// serial | threads | tiled | stream | mpi; неизвестное имя — исключение
+std::unique_ptr<Engine> MakeEngine(const std::string& name, const EngineOptions& opt);
+
+std::unique_ptr<Engine> MakeSerialEngine(const EngineOptions& opt);
+std::unique_ptr<Engine> MakeThreadsEngine(const EngineOptions& opt);
+std::unique_ptr<Engine> MakeTiledEngine(const EngineOptions& opt);
+std::unique_ptr<Engine> MakeStreamEngine(const EngineOptions& opt);
+// Без LAB8_WITH_MPI бросает исключение: программа собрана без MPI
+std::unique_ptr<Engine> MakeMpiEngine(const EngineOptions& opt);
+
+// Запасной путь для плохо обусловленных систем: однопоточное разложение PA = LU с выбором
+// ведущего элемента по столбцу, строки A переставляются на месте; perm[i] — исходный номер
+// строки, стоящей на месте i. Правые части переставляются так же (PermuteRows, condition.h).
+void FactorPivoted(Matrix& A, std::vector<int>& perm);
+
+// Решение L*U*X = R для всех столбцов R (n x m); R заменяется на X.
+// Если правых частей не меньше, чем потоков, столбцы делятся между потоками, иначе —
+// строки каждого блока подстановки (так параллельна и одна правая часть).
+void SolveLU(const Matrix& LU, Matrix& R, int threads);
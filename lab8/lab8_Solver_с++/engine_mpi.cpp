@@ -0,0 +1,281 @@
+#include "engine.h"
+#include <stdexcept>
+
+#ifdef LAB8_WITH_MPI
+#include <mpi.h>
+#include "trace.h"
+#include "kernel.h"
+#include <vector>
+#include <algorithm>
+#include <string>
+
+// Распределённое разложение из lab8_MPI: двумерное блочно-циклическое распределение,
+// блок (I, J) размера nb x nb принадлежит процессу (I % Pr, J % Pc) решётки Pr x Pc.
+// На шаге k строка k рассылается по столбцам решётки, множители — по строкам;
+// строка и столбец k+1 считаются первыми и уходят в путь, пока обновляется хвост шага k.
+// Матрица целиком есть только на ранге 0: он раздаёт блоки и собирает готовое LU,
+// остальные ранги вызывают Factor с пустой матрицей.
+
+struct Grid {
+    int Pr, Pc;
+    int myRow, myCol;
+    int nb;
+    MPI_Comm rowComm;
+    MPI_Comm colComm;
+};
+
+// Сколько из первых n глобальных индексов достаётся процессу p из P
+static int NumLocal(int n, int nb, int p, int P)
+{
+    int blocks = n / nb;
+    int num = (blocks / P) * nb;
+    int extra = blocks % P;
+    if (p < extra) num += nb;
+    else if (p == extra) num += n % nb;
+    return num;
+}
+
+static int OwnerOf(int g, int nb, int P) { return (g / nb) % P; }
+static int LocalIndex(int g, int nb, int P) { return (g / (nb * P)) * nb + g % nb; }
+static int GlobalIndex(int l, int nb, int p, int P) { return (l / nb) * nb * P + p * nb + l % nb; }
+
+struct StepBuffers {
+    std::vector<double> row;
+    std::vector<double> mult;
+    MPI_Request rowReq;
+    MPI_Request multReq;
+};
+
+class MpiEngine : public Engine {
+public:
+    explicit MpiEngine(const EngineOptions& opt) : nb(std::max(1, opt.block)), limits(opt.pivot)
+    {
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &size);
+    }
+
+    const char* Name() const override { return "mpi"; }
+    int Procs() const override { return size; }
+
+    std::string Details() const override
+    {
+        return "решётка " + std::to_string(g.Pr) + "x" + std::to_string(g.Pc) + ", блок " + std::to_string(nb) +
+               ", ожидание обменов на ранге 0 " + std::to_string((long long)(waitTime * 1000)) + " мс";
+    }
+
+    void Factor(Matrix& A) override
+    {
+        int N = (rank == 0) ? A.Rows() : 0;
+        MPI_Bcast(&N, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        // границы ведущих элементов считает ранг 0 по прочитанной A
+        double bounds[2] = { limits.tol, limits.growth };
+        MPI_Bcast(bounds, 2, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        limits.tol = bounds[0];
+        limits.growth = bounds[1];
+
+        int dims[2] = { 0, 0 };
+        MPI_Dims_create(size, 2, dims);
+        g.Pr = dims[0];
+        g.Pc = dims[1];
+        g.myRow = rank / g.Pc;
+        g.myCol = rank % g.Pc;
+        g.nb = nb;
+        MPI_Comm_split(MPI_COMM_WORLD, g.myRow, g.myCol, &g.rowComm);
+        MPI_Comm_split(MPI_COMM_WORLD, g.myCol, g.myRow, &g.colComm);
+
+        int locRows = NumLocal(N, nb, g.myRow, g.Pr);
+        int locCols = NumLocal(N, nb, g.myCol, g.Pc);
+        std::vector<double> local((size_t)locRows * locCols);
+
+        {
+            TraceScope scope("distribute");
+            Exchange(A, N, local, true);
+        }
+        int failed = Eliminate(local.data(), locRows, locCols, N);
+        int firstFailed = 0;
+        {
+            TraceScope scope("barrier");
+            MPI_Allreduce(&failed, &firstFailed, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+        }
+        if (firstFailed == N) {
+            TraceScope scope("gather");
+            Exchange(A, N, local, false);
+        }
+
+        MPI_Comm_free(&g.rowComm);
+        MPI_Comm_free(&g.colComm);
+        if (firstFailed < N) {
+            // |a_kk| плохого шага знают только владельцы столбца k; остальные дают -1
+            double mine = (failed == firstFailed) ? std::fabs(failedPivot) : -1.0, pivot = 0.0;
+            MPI_Allreduce(&mine, &pivot, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+            throw std::runtime_error(limits.Message(pivot, firstFailed));
+        }
+    }
+
+private:
+    // Упаковка блоков ранга p в локальный порядок и обратно; toLocal — раздача с ранга 0
+    void Exchange(Matrix& A, int N, std::vector<double>& local, bool toLocal)
+    {
+        if (rank != 0) {
+            if (toLocal) MPI_Recv(local.data(), (int)local.size(), MPI_DOUBLE, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            else MPI_Send(local.data(), (int)local.size(), MPI_DOUBLE, 0, 1, MPI_COMM_WORLD);
+            return;
+        }
+
+        std::vector<double> buf;
+        for (int p = 0; p < size; ++p) {
+            int pr = p / g.Pc, pc = p % g.Pc;
+            int rows = NumLocal(N, nb, pr, g.Pr);
+            int cols = NumLocal(N, nb, pc, g.Pc);
+            std::vector<double>& dst = (p == 0) ? local : buf;
+            dst.resize((size_t)rows * cols);
+            if (!toLocal && p != 0)
+                MPI_Recv(dst.data(), (int)dst.size(), MPI_DOUBLE, p, 1, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+            for (int li = 0; li < rows; ++li) {
+                double* row = A.Row(GlobalIndex(li, nb, pr, g.Pr));
+                double* loc = dst.data() + (size_t)li * cols;
+                for (int lj = 0; lj < cols; ++lj) {
+                    int gj = GlobalIndex(lj, nb, pc, g.Pc);
+                    if (toLocal) loc[lj] = row[gj];
+                    else row[gj] = loc[lj];
+                }
+            }
+
+            if (toLocal && p != 0)
+                MPI_Send(dst.data(), (int)dst.size(), MPI_DOUBLE, p, 0, MPI_COMM_WORLD);
+        }
+    }
+
+    void PostRowBcast(double* L, int locCols, int k, StepBuffers& sb)
+    {
+        int rowOwner = OwnerOf(k, nb, g.Pr);
+        int lj0 = NumLocal(k, nb, g.myCol, g.Pc);
+        if (g.myRow == rowOwner) {
+            int lk = LocalIndex(k, nb, g.Pr);
+            std::copy(L + (size_t)lk * locCols + lj0, L + (size_t)lk * locCols + locCols, sb.row.data());
+        }
+        MPI_Ibcast(sb.row.data(), locCols - lj0, MPI_DOUBLE, rowOwner, g.colComm, &sb.rowReq);
+    }
+
+    // Владельцы столбца k считают множители, дождавшись akk; при akk за границами limits
+    // шаг отмечается в failed (при нулевом множители не считаются), а рассылки
+    // продолжаются, чтобы остальные ранги не повисли
+    void PostMultBcast(double* L, int locRows, int locCols, int k, StepBuffers& sb, int& failed)
+    {
+        int colOwner = OwnerOf(k, nb, g.Pc);
+        int li0 = NumLocal(k + 1, nb, g.myRow, g.Pr);
+        if (g.myCol == colOwner) {
+            double w0 = MPI_Wtime();
+            MPI_Wait(&sb.rowReq, MPI_STATUS_IGNORE);
+            waitTime += MPI_Wtime() - w0;
+
+            double akk = sb.row[0];
+            int lk = LocalIndex(k, nb, g.Pc);
+            if (limits.Bad(akk) && k < failed) {
+                failed = k;
+                failedPivot = akk;
+            }
+            for (int i = li0; i < locRows; i++) {
+                double factor = (akk == 0.0) ? 0.0 : L[(size_t)i * locCols + lk] / akk;
+                L[(size_t)i * locCols + lk] = factor;
+                sb.mult[i - li0] = factor;
+            }
+        }
+        MPI_Ibcast(sb.mult.data(), locRows - li0, MPI_DOUBLE, colOwner, g.rowComm, &sb.multReq);
+    }
+
+    static void UpdateRange(double* L, int locCols, int i0, int i1, int j0, int j1,
+                            const double* rowK, int rowShift, const double* mult, int multShift)
+    {
+        RowBatch batch(rowK - rowShift, j0, j1);
+        for (int i = i0; i < i1; i++) {
+            double factor = mult[i - multShift];
+            if (factor != 0.0) batch.Add(L + (size_t)i * locCols, factor);
+        }
+    }
+
+    // Возвращает N при успехе или первый шаг с нулевым ведущим элементом
+    int Eliminate(double* L, int locRows, int locCols, int N)
+    {
+        StepBuffers sb[2];
+        for (auto& b : sb) {
+            b.row.resize(std::max(locCols, 1));
+            b.mult.resize(std::max(locRows, 1));
+        }
+        int failed = N;
+        waitTime = 0.0;
+        if (N == 0) return failed;
+
+        PostRowBcast(L, locCols, 0, sb[0]);
+        PostMultBcast(L, locRows, locCols, 0, sb[0], failed);
+
+        for (int k = 0; k < N; k++) {
+            bool sampled = Trace::Sampled(k);
+            StepBuffers& cur = sb[k % 2];
+            double w0 = MPI_Wtime();
+            {
+                TraceScope wait("wait", k, sampled);
+                MPI_Wait(&cur.rowReq, MPI_STATUS_IGNORE);
+                MPI_Wait(&cur.multReq, MPI_STATUS_IGNORE);
+            }
+            waitTime += MPI_Wtime() - w0;
+            TraceScope step("step", k, sampled);
+
+            int lj0 = NumLocal(k, nb, g.myCol, g.Pc);
+            int li0 = NumLocal(k + 1, nb, g.myRow, g.Pr);
+            int lj1 = NumLocal(k + 1, nb, g.myCol, g.Pc);
+            int iRest = li0;
+            int jRest = lj1;
+            StepBuffers& next = sb[(k + 1) % 2];
+
+            if (k + 1 < N) {
+                if (g.myRow == OwnerOf(k + 1, nb, g.Pr)) {
+                    UpdateRange(L, locCols, li0, li0 + 1, lj1, locCols, cur.row.data(), lj0, cur.mult.data(), li0);
+                    iRest = li0 + 1;
+                }
+                if (g.myCol == OwnerOf(k + 1, nb, g.Pc)) {
+                    UpdateRange(L, locCols, iRest, locRows, lj1, lj1 + 1, cur.row.data(), lj0, cur.mult.data(), li0);
+                    jRest = lj1 + 1;
+                }
+                PostRowBcast(L, locCols, k + 1, next);
+                PostMultBcast(L, locRows, locCols, k + 1, next, failed);
+            }
+
+            // остаток хвоста кусками, между ними продвигаются рассылки шага k+1
+            const int slice = 16;
+            for (int s = iRest; s < locRows; s += slice) {
+                UpdateRange(L, locCols, s, std::min(s + slice, locRows), jRest, locCols, cur.row.data(), lj0,
+                            cur.mult.data(), li0);
+                if (k + 1 < N) {
+                    int flag;
+                    MPI_Test(&next.rowReq, &flag, MPI_STATUS_IGNORE);
+                    MPI_Test(&next.multReq, &flag, MPI_STATUS_IGNORE);
+                }
+            }
+        }
+        return failed;
+    }
+
+    int nb;
+    PivotLimits limits;
+    double failedPivot = 0.0;
+    int rank = 0;
+    int size = 1;
+    Grid g{};
+    double waitTime = 0.0;
+};
+
+std::unique_ptr<Engine> MakeMpiEngine(const EngineOptions& opt)
+{
+    return std::unique_ptr<Engine>(new MpiEngine(opt));
+}
+
+#else
+
+std::unique_ptr<Engine> MakeMpiEngine(const EngineOptions&)
+{
+    throw std::runtime_error("Движок mpi недоступен: программа собрана без -DLAB8_WITH_MPI (нужен mpicxx)");
+}
+
+#endif
@@ -0,0 +1,74 @@
+#include "engine.h"
+#include "trace.h"
+#include "kernel.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+// Однопоточное исключение по строкам, как в lab8_singleThread: на шаге k каждая
+// строка ниже k получает множитель на месте a_ik и вычитает ведущую строку
+class SerialEngine : public Engine {
+public:
+    explicit SerialEngine(const EngineOptions& opt) : limits(opt.pivot) {}
+
+    const char* Name() const override { return "serial"; }
+
+    void Factor(Matrix& A) override
+    {
+        const int n = A.Rows();
+        for (int k = 0; k < n - 1; ++k) {
+            TraceScope step("step", k, Trace::Sampled(k));
+            const double* __restrict rowK = A.Row(k);
+            double akk = rowK[k];
+            if (limits.Bad(akk)) throw std::runtime_error(limits.Message(akk, k));
+            RowBatch batch(rowK, k + 1, n);
+            for (int i = k + 1; i < n; ++i) {
+                double* rowI = A.Row(i);
+                if (rowI[k] == 0.0) continue;
+                double factor = rowI[k] / akk;
+                rowI[k] = factor;
+                batch.Add(rowI, factor);
+            }
+        }
+        if (n > 0 && limits.Bad(A(n - 1, n - 1))) throw std::runtime_error(limits.Message(A(n - 1, n - 1), n - 1));
+    }
+
+private:
+    PivotLimits limits;
+};
+
+void FactorPivoted(Matrix& A, std::vector<int>& perm)
+{
+    const int n = A.Rows();
+    perm.resize(n);
+    for (int i = 0; i < n; ++i) perm[i] = i;
+    std::vector<double> tmp(A.Cols());
+    for (int k = 0; k < n; ++k) {
+        int p = k;
+        for (int i = k + 1; i < n; ++i)
+            if (std::abs(A(i, k)) > std::abs(A(p, k))) p = i;
+        if (A(p, k) == 0.0) throw std::runtime_error("Матрица вырождена: нулевой столбец " + std::to_string(k));
+        if (p != k) {
+            std::copy(A.Row(k), A.Row(k) + A.Cols(), tmp.begin());
+            std::copy(A.Row(p), A.Row(p) + A.Cols(), A.Row(k));
+            std::copy(tmp.begin(), tmp.end(), A.Row(p));
+            std::swap(perm[k], perm[p]);
+        }
+        const double* rowK = A.Row(k);
+        RowBatch batch(rowK, k + 1, n);
+        for (int i = k + 1; i < n; ++i) {
+            double* rowI = A.Row(i);
+            if (rowI[k] == 0.0) continue;
+            double factor = rowI[k] / rowK[k];
+            rowI[k] = factor;
+            batch.Add(rowI, factor);
+        }
+    }
+}
+
+std::unique_ptr<Engine> MakeSerialEngine(const EngineOptions& opt)
+{
+    return std::unique_ptr<Engine>(new SerialEngine(opt));
+}
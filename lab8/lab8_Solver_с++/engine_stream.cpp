@@ -0,0 +1,285 @@
+#include "engine.h"
+#include "io.h"
+#include "trace.h"
+#include "kernel.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+// Левостороннее исключение по строкам (Дулиттл): строка i вычитает из себя все готовые
+// строки U с номерами k < i по порядку и сразу становится строкой L и U. Для строки i
+// нужны только строки выше неё, поэтому её можно исключать, как только она прочитана.
+// Читатель (вызывающий поток) разбирает A.txt или A.bin построчно прямо в A и кладёт
+// номера строк в ограниченную очередь; рабочие потоки берут строки из очереди по порядку
+// и исключают их, дожидаясь готовности нужных строк U. Строки готовы строго по порядку:
+// строка i+1 не закончится раньше строки i, так что готовность — один счётчик readyRows.
+// Каждый элемент получает те же операции ядра (kernel.h) в том же порядке k, что и у
+// правостороннего исключения, поэтому результат совпадает с serial побитно.
+class StreamEngine : public Engine {
+public:
+    explicit StreamEngine(const EngineOptions& opt)
+        : numThreads(std::max(1, opt.threads)), queueRows(std::max(1, opt.queueRows)), limits(opt.pivot)
+    {
+    }
+
+    const char* Name() const override { return "stream"; }
+
+    std::string Details() const override
+    {
+        std::string s = "потоков " + std::to_string(numThreads) + ", очередь " + std::to_string(queueRows) + " строк" +
+                        ", ожидание строк U " + std::to_string((long long)(pivotWaitNs.load() / 1000000)) + " мс";
+        if (streamed)
+            s += ", разбор " + std::to_string((long long)parseMs) + " мс, читатель ждал очередь " +
+                 std::to_string((long long)readerWaitMs) + " мс, пик очереди " + std::to_string(queuePeak);
+        return s;
+    }
+
+    // Строки уже в памяти: тот же конвейер без читателя
+    void Factor(Matrix& A) override
+    {
+        Start(A, A.Rows());
+        streamed = false;
+        nextRow = 0;
+        RunWorkers([this](int& i) {
+            i = nextRow.fetch_add(1);
+            return i < n && !failed.load();
+        });
+        Finish();
+    }
+
+    bool ReadAndFactor(const std::string& folder, Matrix& A, Matrix& B, bool preferText, const MemoryOptions& mem,
+                       double& loadMs) override
+    {
+        TraceScope whole("factor");
+        auto t0 = std::chrono::steady_clock::now();
+        streamed = true;
+        a = &A;
+        n = 0;
+        failed = false;
+        inputError = false;
+        readerDone = false;
+        queue.clear();
+        queuePeak = 0;
+        readerWaitMs = 0;
+        pivotWaitNs = 0;
+        errorText.clear();
+
+        std::vector<std::thread> pool;
+        for (int t = 0; t < numThreads; ++t)
+            pool.emplace_back([this, t] {
+                Trace::SetThreadName("stream/" + std::to_string(t));
+                int i;
+                while (PopRow(i)) EliminateRow(i);
+            });
+
+        try {
+            TraceScope scope("read");
+            std::ifstream bin;
+            if (!preferText && BinaryMatrixCurrent(folder)) bin.open(folder + "/A.bin", std::ios::binary);
+            if (bin.is_open()) ReadBinary(bin, A, mem);
+            else ReadText(folder + "/A.txt", A, mem);
+            parseMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            ReadRightHandSides(folder, n, B);
+        }
+        catch (const std::exception& e) {
+            Fail(e.what(), true);
+        }
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            readerDone = true;
+        }
+        cvNotEmpty.notify_all();
+        loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+        for (auto& th : pool) th.join();
+        Finish();
+        return true;
+    }
+
+private:
+    void Start(Matrix& A, int rows)
+    {
+        a = &A;
+        n = rows;
+        readyRows = 0;
+        failed = false;
+        inputError = false;
+        pivotWaitNs = 0;
+        errorText.clear();
+    }
+
+    void Finish()
+    {
+        if (inputError) throw std::invalid_argument(errorText);
+        if (!errorText.empty()) throw std::runtime_error(errorText);
+    }
+
+    // Сохраняется первая ошибка: если читатель остановился из-за того, что уже упало
+    // исключение, это ошибка разложения, а не входных данных
+    void Fail(const std::string& what, bool input = false)
+    {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (errorText.empty()) {
+                errorText = what;
+                inputError = input;
+            }
+            failed = true;
+        }
+        cvNotEmpty.notify_all();
+        cvNotFull.notify_all();
+    }
+
+    template <class Source>
+    void RunWorkers(Source next)
+    {
+        std::vector<std::thread> pool;
+        for (int t = 1; t < numThreads; ++t)
+            pool.emplace_back([this, t, next] {
+                Trace::SetThreadName("stream/" + std::to_string(t));
+                int i;
+                while (next(i)) EliminateRow(i);
+            });
+        int i;
+        while (next(i)) EliminateRow(i);
+        for (auto& th : pool) th.join();
+    }
+
+    // Читатель: строка i уже записана в A, её номер ставится в очередь
+    void PushRow(int i)
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        if ((int)queue.size() >= queueRows) {
+            auto w0 = std::chrono::steady_clock::now();
+            cvNotFull.wait(lock, [this] { return (int)queue.size() < queueRows || failed.load(); });
+            readerWaitMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - w0).count();
+        }
+        if (failed) throw std::runtime_error(errorText);
+        queue.push_back(i);
+        queuePeak = std::max(queuePeak, (int)queue.size());
+        lock.unlock();
+        cvNotEmpty.notify_one();
+    }
+
+    bool PopRow(int& i)
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        cvNotEmpty.wait(lock, [this] { return !queue.empty() || readerDone || failed.load(); });
+        if (failed || queue.empty()) return false;
+        i = queue.front();
+        queue.pop_front();
+        lock.unlock();
+        cvNotFull.notify_one();
+        return true;
+    }
+
+    // Размер известен по первой строке: тогда и выделяется A, а n публикуется
+    // рабочим вместе с первой строкой через мьютекс очереди
+    void Allocate(Matrix& A, int rows, const MemoryOptions& mem)
+    {
+        A.Resize(rows, rows, mem);
+        std::lock_guard<std::mutex> lock(queueMutex);
+        n = rows;
+        readyRows = 0;
+    }
+
+    void ReadText(const std::string& path, Matrix& A, const MemoryOptions& mem)
+    {
+        std::ifstream fin(path, std::ios::binary);
+        if (!fin) throw std::runtime_error("Cannot open " + path);
+        std::string line;
+        std::vector<double> row;
+        int i = 0;
+        while (std::getline(fin, line)) {
+            const char* p = line.data();
+            ParseLine(p, p + line.size(), row);
+            if (row.empty()) continue;
+            if (i == 0) Allocate(A, (int)row.size(), mem);
+            if ((int)row.size() != n) throw std::runtime_error("A.txt: inconsistent row size");
+            std::copy(row.begin(), row.end(), A.Row(i));
+            PushRow(i);
+            if (++i == n) break;
+        }
+        if (i == 0) throw std::runtime_error("Empty A.txt");
+        if (i < n) throw std::runtime_error("A.txt: matrix is not square");
+    }
+
+    void ReadBinary(std::ifstream& fin, Matrix& A, const MemoryOptions& mem)
+    {
+        long long rows = 0;
+        fin.read((char*)&rows, sizeof(rows));
+        if (!fin || rows <= 0) throw std::runtime_error("A.bin: bad header");
+        Allocate(A, (int)rows, mem);
+        for (int i = 0; i < n; ++i) {
+            fin.read((char*)A.Row(i), (std::streamsize)((size_t)n * sizeof(double)));
+            if (!fin) throw std::runtime_error("A.bin: file is truncated");
+            PushRow(i);
+        }
+    }
+
+    void EliminateRow(int i)
+    {
+        TraceScope scope("row", i, Trace::Sampled(i));
+        double* row = a->Row(i);
+        int ready = readyRows.load(std::memory_order_acquire);
+        for (int k = 0; k < i; ++k) {
+            if (k >= ready) {
+                uint64_t w0 = Trace::NowNs();
+                while ((ready = readyRows.load(std::memory_order_acquire)) <= k) {
+                    if (failed.load(std::memory_order_relaxed)) return;
+                    std::this_thread::yield();
+                }
+                uint64_t w1 = Trace::NowNs();
+                pivotWaitNs.fetch_add(w1 - w0, std::memory_order_relaxed);
+                if (Trace::Sampled(i)) Trace::Record("wait", w0, w1, i);
+            }
+            double f = row[k];
+            if (f == 0.0) continue;
+            const double* u = a->Row(k);
+            f /= u[k];
+            row[k] = f;
+            UpdateRows(u, &row, &f, 1, k + 1, n);
+        }
+        if (limits.Bad(row[i])) {
+            Fail(limits.Message(row[i], i));
+            return;
+        }
+        readyRows.store(i + 1, std::memory_order_release);
+    }
+
+    int numThreads;
+    int queueRows;
+    PivotLimits limits;
+
+    Matrix* a = nullptr;
+    int n = 0;
+    std::atomic<int> readyRows{ 0 };
+    std::atomic<int> nextRow{ 0 };
+    std::atomic<bool> failed{ false };
+    std::atomic<unsigned long long> pivotWaitNs{ 0 };
+
+    std::mutex queueMutex;
+    std::condition_variable cvNotEmpty, cvNotFull;
+    std::deque<int> queue;
+    bool readerDone = false;
+    bool inputError = false;
+    std::string errorText;
+
+    bool streamed = false;
+    int queuePeak = 0;
+    double parseMs = 0;
+    double readerWaitMs = 0;
+};
+
+std::unique_ptr<Engine> MakeStreamEngine(const EngineOptions& opt)
+{
+    return std::unique_ptr<Engine>(new StreamEngine(opt));
+}
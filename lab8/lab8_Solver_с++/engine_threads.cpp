@@ -0,0 +1,207 @@
+#include "engine.h"
+#include "topology.h"
+#include "trace.h"
+#include "kernel.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+// Пул потоков с шагом k, как в linux_main: главный поток объявляет шаг и сам
+// обрабатывает долю потока 0, остальные ждут номер шага stepId.
+// Строки ниже k раздаются одним из трёх способов:
+//   block   — непрерывный диапазон строк на поток;
+//   cyclic  — блоки по block строк, блок b достаётся потоку b % threads;
+//   dynamic — порции по block строк из атомарного счётчика.
+// При --affinity поток id закреплён за своим CPU, а FirstTouch обнуляет строки теми же
+// потоками, поэтому при first-touch страницы строк лежат на узле потока, который их считает
+// (для dynamic владельца нет — страницы раскладываются как для cyclic).
+enum class DistMode { Block, Cyclic, Dynamic };
+
+static DistMode ParseDistMode(const std::string& s)
+{
+    if (s == "block") return DistMode::Block;
+    if (s == "cyclic") return DistMode::Cyclic;
+    if (s == "dynamic") return DistMode::Dynamic;
+    throw std::runtime_error("Unknown --dist value: " + s);
+}
+
+class ThreadsEngine : public Engine {
+public:
+    explicit ThreadsEngine(const EngineOptions& opt)
+        : numThreads(std::max(1, opt.threads)), blockSize(std::max(1, opt.block)),
+          distName(opt.dist), distMode(ParseDistMode(opt.dist)), affinity(ParseAffinity(opt.affinity)),
+          limits(opt.pivot)
+    {
+        cpus = PlanAffinity(affinity, numThreads, ReadTopology());
+    }
+
+    const char* Name() const override { return "threads"; }
+
+    std::string Details() const override
+    {
+        return "потоков " + std::to_string(numThreads) + ", раздача " + distName + ", блок " + std::to_string(blockSize) +
+               ", закрепление " + AffinityName(affinity);
+    }
+
+    void FirstTouch(Matrix& A) override
+    {
+        n = A.Rows();
+        DistMode layout = (distMode == DistMode::Dynamic) ? DistMode::Cyclic : distMode;
+        RunOnThreads(numThreads, cpus, [&](int id) {
+            ForOwnedRows(layout, id, 0, [&](int i) { std::memset(A.Row(i), 0, A.Stride() * sizeof(double)); });
+        });
+    }
+
+    void Factor(Matrix& A) override
+    {
+        a = &A;
+        n = A.Rows();
+        stepId = 0;
+        finishedCount = 0;
+        terminate = false;
+
+        std::vector<std::thread> pool;
+        for (int t = 1; t < numThreads; ++t) pool.emplace_back(&ThreadsEngine::WorkerRoutine, this, t);
+        AffinityGuard guard;
+        if (!cpus.empty()) PinCurrentThread(cpus[0]);
+
+        std::string error;
+        for (int k = 0; k < n; ++k) {
+            if (limits.Bad(A(k, k))) {
+                error = limits.Message(A(k, k), k);
+                break;
+            }
+            if (k == n - 1) break;
+            {
+                std::lock_guard<std::mutex> lock(m);
+                currentK = k;
+                nextRow.store(k + 1, std::memory_order_relaxed);
+                finishedCount = 0;
+                ++stepId;
+            }
+            cvStart.notify_all();
+            bool sampled = Trace::Sampled(k);
+            {
+                TraceScope step("step", k, sampled);
+                ProcessStep(0, k);
+            }
+
+            TraceScope wait("barrier", k, sampled);
+            std::unique_lock<std::mutex> lock(m);
+            ++finishedCount;
+            cvDone.wait(lock, [this] { return finishedCount == numThreads; });
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m);
+            terminate = true;
+        }
+        cvStart.notify_all();
+        for (auto& th : pool) th.join();
+        if (!error.empty()) throw std::runtime_error(error);
+    }
+
+private:
+    // Строка i по ведущей строке k; множитель остаётся на месте a_ik, а само
+    // вычитание копится в batch и делается ядром по нескольку строк сразу
+    void EliminateRow(RowBatch& batch, int k, int i)
+    {
+        double* rowI = a->Row(i);
+        if (rowI[k] == 0.0) return;
+        double factor = rowI[k] / a->Row(k)[k];
+        rowI[k] = factor;
+        batch.Add(rowI, factor);
+    }
+
+    // Строки >= first, принадлежащие потоку id при раскладке block или cyclic
+    template <class F>
+    void ForOwnedRows(DistMode layout, int id, int first, F f) const
+    {
+        if (layout == DistMode::Block) {
+            int rowsPer = (n + numThreads - 1) / numThreads;
+            int rowEnd = std::min((id + 1) * rowsPer, n);
+            for (int i = std::max(id * rowsPer, first); i < rowEnd; ++i) f(i);
+            return;
+        }
+        // первый свой блок, в котором есть строки >= first
+        int b0 = first / blockSize;
+        int b = b0 + ((id - b0 % numThreads) + numThreads) % numThreads;
+        for (; b * blockSize < n; b += numThreads) {
+            int rowEnd = std::min((b + 1) * blockSize, n);
+            for (int i = std::max(b * blockSize, first); i < rowEnd; ++i) f(i);
+        }
+    }
+
+    void ProcessStep(int id, int k)
+    {
+        RowBatch batch(a->Row(k), k + 1, n);
+        if (distMode != DistMode::Dynamic) {
+            ForOwnedRows(distMode, id, k + 1, [&](int i) { EliminateRow(batch, k, i); });
+            return;
+        }
+        while (true) {
+            int rowBegin = nextRow.fetch_add(blockSize, std::memory_order_relaxed);
+            if (rowBegin >= n) break;
+            int rowEnd = std::min(rowBegin + blockSize, n);
+            for (int i = rowBegin; i < rowEnd; ++i) EliminateRow(batch, k, i);
+        }
+    }
+
+    void WorkerRoutine(int id)
+    {
+        if (!cpus.empty()) PinCurrentThread(cpus[id]);
+        Trace::SetThreadName("threads/" + std::to_string(id));
+        long seenStep = 0;
+        while (true) {
+            int k;
+            uint64_t waitStart = Trace::Enabled() ? Trace::NowNs() : 0;
+            {
+                std::unique_lock<std::mutex> lock(m);
+                cvStart.wait(lock, [&] { return stepId != seenStep || terminate; });
+                if (terminate) return;
+                seenStep = stepId;
+                k = currentK;
+            }
+
+            // ожидание шага пишется задним числом, когда стало известно, попал ли шаг в выборку
+            bool sampled = Trace::Sampled(k);
+            if (sampled) Trace::Record("wait", waitStart, Trace::NowNs(), k);
+            {
+                TraceScope step("step", k, sampled);
+                ProcessStep(id, k);
+            }
+
+            std::lock_guard<std::mutex> lock(m);
+            if (++finishedCount == numThreads) cvDone.notify_one();
+        }
+    }
+
+    int numThreads;
+    int blockSize;
+    std::string distName;
+    DistMode distMode;
+    Affinity affinity;
+    std::vector<int> cpus;
+    PivotLimits limits;
+
+    Matrix* a = nullptr;
+    int n = 0;
+    std::mutex m;
+    std::condition_variable cvStart, cvDone;
+    long stepId = 0;
+    int currentK = -1;
+    int finishedCount = 0;
+    bool terminate = false;
+    std::atomic<int> nextRow{ 0 };
+};
+
+std::unique_ptr<Engine> MakeThreadsEngine(const EngineOptions& opt)
+{
+    return std::unique_ptr<Engine>(new ThreadsEngine(opt));
+}
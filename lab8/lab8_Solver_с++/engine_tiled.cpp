@@ -0,0 +1,340 @@
+#include "engine.h"
+#include "topology.h"
+#include "trace.h"
+#include "kernel.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+// Плиточное LU из lab8_Tiled: шаги разбиты на задачи с графом зависимостей
+//   P(k)     — разложение диагональной плитки (k,k)
+//   U(k,j)   — треугольное решение для плитки строки k
+//   L(i,k)   — треугольное решение для плитки столбца k
+//   G(i,j,k) — обновление плитки (i,j) на шаге k
+// Задача попадает в очередь, как только выполнены все её предшественники.
+// Закреплённого владельца у плитки нет (задачи крадутся), поэтому FirstTouch раскладывает
+// строки плиток по потокам циклически: полоса плиток I — потоку I % threads.
+
+enum class TaskType { Panel, RowSolve, ColSolve, Update };
+
+struct Task {
+    TaskType type;
+    int i;
+    int j;
+    int k;
+};
+
+// high — задачи критического пути, low — остальное обновление хвоста.
+// Своя очередь берётся с конца, чужая — с начала.
+struct WorkerQueue {
+    std::mutex m;
+    std::deque<Task> high;
+    std::deque<Task> low;
+};
+
+class TiledEngine : public Engine {
+public:
+    explicit TiledEngine(const EngineOptions& opt)
+        : numThreads(std::max(1, opt.threads)), NB(opt.tile), affinity(ParseAffinity(opt.affinity)), limits(opt.pivot)
+    {
+        if (NB <= 0) throw std::runtime_error("--tile must be positive");
+        cpus = PlanAffinity(affinity, numThreads, ReadTopology());
+    }
+
+    const char* Name() const override { return "tiled"; }
+
+    std::string Details() const override
+    {
+        return "потоков " + std::to_string(numThreads) + ", плитка " + std::to_string(NB) + " (" + std::to_string(T) + "x" +
+               std::to_string(T) + "), краж задач " + std::to_string(stealCount.load()) + ", закрепление " +
+               AffinityName(affinity);
+    }
+
+    void FirstTouch(Matrix& A) override
+    {
+        int bands = (A.Rows() + NB - 1) / NB;
+        RunOnThreads(numThreads, cpus, [&](int id) {
+            for (int I = id; I < bands; I += numThreads) {
+                int r1 = std::min((I + 1) * NB, A.Rows());
+                for (int r = I * NB; r < r1; ++r) std::memset(A.Row(r), 0, A.Stride() * sizeof(double));
+            }
+        });
+    }
+
+    void Factor(Matrix& A) override
+    {
+        a = &A;
+        N = A.Rows();
+        T = (N + NB - 1) / NB;
+        size_t TT = (size_t)T * T;
+        depsPanel.reset(new std::atomic<int>[T]);
+        depsRow.reset(new std::atomic<int>[TT]);
+        depsCol.reset(new std::atomic<int>[TT]);
+        depsUpdate.reset(new std::atomic<int>[TT * T]);
+
+        long total = 0;
+        for (int k = 0; k < T; ++k) {
+            depsPanel[k] = (k > 0) ? 1 : 0;
+            ++total;
+            for (int j = k + 1; j < T; ++j) {
+                depsRow[(size_t)k * T + j] = 1 + (k > 0);
+                depsCol[(size_t)j * T + k] = 1 + (k > 0);
+                total += 2;
+            }
+            for (int i = k + 1; i < T; ++i)
+                for (int j = k + 1; j < T; ++j) {
+                    UpdateDeps(i, j, k) = 2 + (k > 0);
+                    ++total;
+                }
+        }
+
+        queues.clear();
+        for (int t = 0; t < numThreads; ++t) queues.emplace_back(new WorkerQueue());
+        tasksLeft = total;
+        tasksReady = 0;
+        stealCount = 0;
+        errorText.clear();
+        PushTask(0, { TaskType::Panel, 0, 0, 0 });
+
+        RunOnThreads(numThreads, cpus, [this](int id) { WorkerRoutine(id); });
+
+        if (!errorText.empty()) throw std::runtime_error(errorText);
+    }
+
+private:
+    double* Tile(int i, int j) { return a->Row(i * NB) + (size_t)j * NB; }
+    int TileSize(int i) const { return std::min(NB, N - i * NB); }
+    std::atomic<int>& UpdateDeps(int i, int j, int k) { return depsUpdate[((size_t)k * T + i) * T + j]; }
+
+    // Разложение диагональной плитки на месте: L — единичная нижняя, U — верхняя
+    void KernelPanel(int k)
+    {
+        const size_t ld = a->Stride();
+        double* t = Tile(k, k);
+        int m = TileSize(k);
+        for (int p = 0; p < m; ++p) {
+            double app = t[(size_t)p * ld + p];
+            if (limits.Bad(app)) throw std::runtime_error(limits.Message(app, k * NB + p));
+            for (int r = p + 1; r < m; ++r) {
+                double* rowR = t + (size_t)r * ld;
+                const double* rowP = t + (size_t)p * ld;
+                double l = rowR[p] / app;
+                rowR[p] = l;
+                for (int c = p + 1; c < m; ++c) rowR[c] -= l * rowP[c];
+            }
+        }
+    }
+
+    // U(k,j) = L(k,k)^-1 * A(k,j)
+    void KernelRowSolve(int k, int j)
+    {
+        const size_t ld = a->Stride();
+        const double* l = Tile(k, k);
+        double* t = Tile(k, j);
+        int m = TileSize(k);
+        int w = TileSize(j);
+        for (int p = 0; p < m; ++p) {
+            const double* rowP = t + (size_t)p * ld;
+            for (int r = p + 1; r < m; ++r) {
+                double f = l[(size_t)r * ld + p];
+                if (f == 0.0) continue;
+                double* rowR = t + (size_t)r * ld;
+                for (int c = 0; c < w; ++c) rowR[c] -= f * rowP[c];
+            }
+        }
+    }
+
+    // L(i,k) = A(i,k) * U(k,k)^-1
+    void KernelColSolve(int i, int k)
+    {
+        const size_t ld = a->Stride();
+        const double* u = Tile(k, k);
+        double* t = Tile(i, k);
+        int h = TileSize(i);
+        int m = TileSize(k);
+        for (int r = 0; r < h; ++r) {
+            double* rowR = t + (size_t)r * ld;
+            for (int p = 0; p < m; ++p) {
+                const double* rowU = u + (size_t)p * ld;
+                double l = rowR[p] / rowU[p];
+                rowR[p] = l;
+                if (l == 0.0) continue;
+                for (int c = p + 1; c < m; ++c) rowR[c] -= l * rowU[c];
+            }
+        }
+    }
+
+    // A(i,j) -= L(i,k) * U(k,j)
+    void KernelUpdate(int i, int j, int k)
+    {
+        const size_t ld = a->Stride();
+        const double* l = Tile(i, k);
+        const double* u = Tile(k, j);
+        double* t = Tile(i, j);
+        int h = TileSize(i);
+        int m = TileSize(k);
+        int w = TileSize(j);
+        // по строкам U снаружи: каждая строка U идёт в ядро сразу с группой строк A
+        for (int p = 0; p < m; ++p) {
+            RowBatch batch(u + (size_t)p * ld, 0, w);
+            for (int r = 0; r < h; ++r) {
+                double f = l[(size_t)r * ld + p];
+                if (f != 0.0) batch.Add(t + (size_t)r * ld, f);
+            }
+        }
+    }
+
+    static bool IsCritical(const Task& t)
+    {
+        if (t.type != TaskType::Update) return true;
+        return t.i == t.k + 1 || t.j == t.k + 1;
+    }
+
+    void PushTask(int self, const Task& t)
+    {
+        WorkerQueue& q = *queues[self];
+        {
+            std::lock_guard<std::mutex> lock(q.m);
+            if (IsCritical(t)) q.high.push_back(t);
+            else q.low.push_back(t);
+        }
+        tasksReady.fetch_add(1);
+        idleCv.notify_one();
+    }
+
+    bool PopTask(int self, Task& out)
+    {
+        // своя high, чужие high, своя low, чужие low
+        for (int pass = 0; pass < 2; ++pass) {
+            bool high = (pass == 0);
+            {
+                WorkerQueue& q = *queues[self];
+                std::lock_guard<std::mutex> lock(q.m);
+                std::deque<Task>& d = high ? q.high : q.low;
+                if (!d.empty()) {
+                    out = d.back();
+                    d.pop_back();
+                    tasksReady.fetch_sub(1);
+                    return true;
+                }
+            }
+            for (int s = 1; s < numThreads; ++s) {
+                WorkerQueue& q = *queues[(self + s) % numThreads];
+                std::lock_guard<std::mutex> lock(q.m);
+                std::deque<Task>& d = high ? q.high : q.low;
+                if (!d.empty()) {
+                    out = d.front();
+                    d.pop_front();
+                    tasksReady.fetch_sub(1);
+                    stealCount.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void Release(int self, std::atomic<int>& counter, const Task& t)
+    {
+        if (counter.fetch_sub(1) == 1) PushTask(self, t);
+    }
+
+    void RunTask(int self, const Task& t)
+    {
+        static const char* const names[] = { "panel", "rowsolve", "colsolve", "update" };
+        TraceScope scope(names[(int)t.type], t.k);
+        switch (t.type) {
+            case TaskType::Panel:
+                KernelPanel(t.k);
+                for (int j = t.k + 1; j < T; ++j)
+                    Release(self, depsRow[(size_t)t.k * T + j], { TaskType::RowSolve, t.k, j, t.k });
+                for (int i = t.k + 1; i < T; ++i)
+                    Release(self, depsCol[(size_t)i * T + t.k], { TaskType::ColSolve, i, t.k, t.k });
+                break;
+            case TaskType::RowSolve:
+                KernelRowSolve(t.k, t.j);
+                for (int i = t.k + 1; i < T; ++i)
+                    Release(self, UpdateDeps(i, t.j, t.k), { TaskType::Update, i, t.j, t.k });
+                break;
+            case TaskType::ColSolve:
+                KernelColSolve(t.i, t.k);
+                for (int j = t.k + 1; j < T; ++j)
+                    Release(self, UpdateDeps(t.i, j, t.k), { TaskType::Update, t.i, j, t.k });
+                break;
+            case TaskType::Update: {
+                KernelUpdate(t.i, t.j, t.k);
+                int n = t.k + 1;
+                if (t.i == n && t.j == n)
+                    Release(self, depsPanel[n], { TaskType::Panel, n, n, n });
+                else if (t.i == n)
+                    Release(self, depsRow[(size_t)n * T + t.j], { TaskType::RowSolve, n, t.j, n });
+                else if (t.j == n)
+                    Release(self, depsCol[(size_t)t.i * T + n], { TaskType::ColSolve, t.i, n, n });
+                else
+                    Release(self, UpdateDeps(t.i, t.j, n), { TaskType::Update, t.i, t.j, n });
+                break;
+            }
+        }
+        tasksLeft.fetch_sub(1);
+    }
+
+    void WorkerRoutine(int self)
+    {
+        if (self > 0) Trace::SetThreadName("tiled/" + std::to_string(self));
+        Task t;
+        while (tasksLeft.load() > 0) {
+            if (PopTask(self, t)) {
+                try {
+                    RunTask(self, t);
+                }
+                catch (const std::exception& e) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (errorText.empty()) errorText = e.what();
+                    tasksLeft = 0;
+                }
+                if (tasksLeft.load() == 0) idleCv.notify_all();
+                continue;
+            }
+            TraceScope idle("idle");
+            std::unique_lock<std::mutex> lock(idleMutex);
+            idleCv.wait_for(lock, std::chrono::milliseconds(1),
+                            [this] { return tasksReady.load() > 0 || tasksLeft.load() == 0; });
+        }
+    }
+
+    int numThreads;
+    int NB;
+    Affinity affinity;
+    std::vector<int> cpus;
+    PivotLimits limits;
+    Matrix* a = nullptr;
+    int N = 0;
+    int T = 0;
+
+    std::unique_ptr<std::atomic<int>[]> depsPanel;
+    std::unique_ptr<std::atomic<int>[]> depsRow;
+    std::unique_ptr<std::atomic<int>[]> depsCol;
+    std::unique_ptr<std::atomic<int>[]> depsUpdate;
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::atomic<long> tasksLeft{ 0 };
+    std::atomic<long> tasksReady{ 0 };
+    std::atomic<long> stealCount{ 0 };
+    std::mutex idleMutex;
+    std::condition_variable idleCv;
+    std::mutex errorMutex;
+    std::string errorText;
+};
+
+std::unique_ptr<Engine> MakeTiledEngine(const EngineOptions& opt)
+{
+    return std::unique_ptr<Engine>(new TiledEngine(opt));
+}
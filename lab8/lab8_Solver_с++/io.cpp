@@ -0,0 +1,210 @@
+#include "io.h"
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <charconv>
+#include <thread>
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+static std::string ReadWholeFile(const std::string& path)
+{
+    std::ifstream fin(path, std::ios::binary);
+    if (!fin) throw std::runtime_error("Cannot open " + path);
+    std::ostringstream ss;
+    ss << fin.rdbuf();
+    return ss.str();
+}
+
+void ParseLine(const char*& p, const char* end, std::vector<double>& row)
+{
+    row.clear();
+    while (p < end && *p != '\n') {
+        if (*p == ' ' || *p == '\t' || *p == '\r') {
+            ++p;
+            continue;
+        }
+        char* next = nullptr;
+        double v = std::strtod(p, &next);
+        if (next == p) throw std::runtime_error("Bad number in input");
+        row.push_back(v);
+        p = next;
+    }
+    if (p < end) ++p;
+}
+
+static void ReadTextMatrix(const std::string& path, Matrix& A, const MemoryOptions& mem)
+{
+    std::string text = ReadWholeFile(path);
+    const char* p = text.data();
+    const char* end = p + text.size();
+
+    std::vector<double> row;
+    std::vector<std::vector<double>> rows;
+    while (p < end) {
+        ParseLine(p, end, row);
+        if (!row.empty()) rows.push_back(row);
+    }
+    int n = (int)rows.size();
+    if (n == 0) throw std::runtime_error("Empty A.txt");
+
+    A.Resize(n, n, mem);
+    for (int i = 0; i < n; ++i) {
+        if ((int)rows[i].size() != n) throw std::runtime_error("A.txt: inconsistent row size");
+        std::copy(rows[i].begin(), rows[i].end(), A.Row(i));
+    }
+}
+
+static bool ReadBinaryMatrix(const std::string& path, Matrix& A, const MemoryOptions& mem)
+{
+    std::ifstream fin(path, std::ios::binary);
+    if (!fin) return false;
+    long long n = 0;
+    fin.read((char*)&n, sizeof(n));
+    if (!fin || n <= 0) throw std::runtime_error("A.bin: bad header");
+
+    A.Resize((int)n, (int)n, mem);
+    for (int i = 0; i < (int)n; ++i)
+        fin.read((char*)A.Row(i), (std::streamsize)(n * sizeof(double)));
+    if (!fin) throw std::runtime_error("A.bin: file is truncated");
+    return true;
+}
+
+// Время изменения в наносекундах; false — файла нет
+static bool StatFile(const std::string& path, long long& mtimeNs, long long& size)
+{
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) return false;
+    mtimeNs = (long long)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    size = (long long)st.st_size;
+    return true;
+}
+
+// Непустые строки B.txt — порядок системы
+static long long CountDataLines(const std::string& path)
+{
+    std::ifstream fin(path);
+    long long lines = 0;
+    std::string line;
+    while (std::getline(fin, line))
+        if (line.find_first_not_of(" \t\r") != std::string::npos) ++lines;
+    return lines;
+}
+
+bool BinaryMatrixCurrent(const std::string& folder)
+{
+    long long binTime = 0, binSize = 0, txtTime = 0, txtSize = 0;
+    if (!StatFile(folder + "/A.bin", binTime, binSize)) return false;
+    // без A.txt выбирать не из чего: несоответствие покажет само чтение
+    if (!StatFile(folder + "/A.txt", txtTime, txtSize)) return true;
+    if (txtTime > binTime) return false;
+
+    std::ifstream fin(folder + "/A.bin", std::ios::binary);
+    long long n = 0;
+    if (!fin.read((char*)&n, sizeof(n)) || n <= 0 || n > INT_MAX) return false;
+    if (binSize != (long long)sizeof(n) + n * n * (long long)sizeof(double)) return false;
+    return CountDataLines(folder + "/B.txt") == n;
+}
+
+void ReadSystem(const std::string& folder, Matrix& A, Matrix& B, bool preferText, const MemoryOptions& mem)
+{
+    if (preferText || !BinaryMatrixCurrent(folder) || !ReadBinaryMatrix(folder + "/A.bin", A, mem))
+        ReadTextMatrix(folder + "/A.txt", A, mem);
+    ReadRightHandSides(folder, A.Rows(), B);
+}
+
+void ReadRightHandSides(const std::string& folder, int n, Matrix& B)
+{
+    std::string text = ReadWholeFile(folder + "/B.txt");
+    const char* p = text.data();
+    const char* end = p + text.size();
+    std::vector<double> row;
+    std::vector<double> values;
+    int m = 0;
+    while (p < end && (int)values.size() < n * std::max(m, 1)) {
+        ParseLine(p, end, row);
+        if (row.empty()) continue;
+        if (m == 0) m = (int)row.size();
+        else if ((int)row.size() != m) throw std::runtime_error("B.txt: inconsistent row size");
+        values.insert(values.end(), row.begin(), row.end());
+    }
+    if (m == 0 || (long long)values.size() != (long long)n * m) throw std::runtime_error("B.txt not match size");
+
+    B.Resize(n, m);
+    for (int i = 0; i < n; ++i)
+        std::copy(values.begin() + (size_t)i * m, values.begin() + (size_t)(i + 1) * m, B.Row(i));
+}
+
+// Самое длинное кратчайшее представление double: "-2.2250738585072014e-308" — 24 символа,
+// плюс разделитель
+static const size_t MaxDoubleChars = 25;
+
+// Строки [r0, r1) в buf; возвращает длину
+static size_t FormatRows(const Matrix& X, int r0, int r1, char* buf)
+{
+    char* p = buf;
+    const int m = X.Cols();
+    for (int i = r0; i < r1; ++i) {
+        const double* row = X.Row(i);
+        for (int j = 0; j < m; ++j) {
+            p = std::to_chars(p, p + MaxDoubleChars, row[j]).ptr;
+            *p++ = (j + 1 < m) ? ' ' : '\n';
+        }
+    }
+    return (size_t)(p - buf);
+}
+
+void WriteSolution(const std::string& path, const Matrix& X, int threads)
+{
+    // Кусок — не меньше ~4096 чисел, иначе потоки дороже форматирования
+    const long long values = (long long)X.Rows() * X.Cols();
+    int chunks = (int)std::max(1LL, std::min<long long>(std::max(1, threads), values / 4096));
+    chunks = std::min(chunks, std::max(1, X.Rows()));
+    const int per = (X.Rows() + chunks - 1) / std::max(1, chunks);
+
+    // Каждый кусок форматируется в свою часть одного буфера, рассчитанного на худший
+    // случай; куски уходят в файл одним writev без склейки
+    std::vector<char> buf((size_t)values * MaxDoubleChars + 1);
+    std::vector<struct iovec> parts(chunks);
+    auto format = [&](int c) {
+        int r0 = std::min(X.Rows(), c * per), r1 = std::min(X.Rows(), r0 + per);
+        char* dst = buf.data() + (size_t)r0 * X.Cols() * MaxDoubleChars;
+        parts[c].iov_base = dst;
+        parts[c].iov_len = FormatRows(X, r0, r1, dst);
+    };
+    std::vector<std::thread> pool;
+    for (int c = 1; c < chunks; ++c) pool.emplace_back(format, c);
+    format(0);
+    for (auto& th : pool) th.join();
+
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) throw std::runtime_error("Cannot write " + path);
+    // writev может записать не всё; дописываем остаток, сдвигая iovec
+    struct iovec* iov = parts.data();
+    int count = chunks;
+    while (count > 0) {
+        ssize_t done = ::writev(fd, iov, std::min(count, IOV_MAX));
+        if (done < 0) {
+            if (errno == EINTR) continue;
+            ::close(fd);
+            throw std::runtime_error("Cannot write " + path);
+        }
+        while (count > 0 && (size_t)done >= iov->iov_len) {
+            done -= (ssize_t)iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (count > 0) {
+            iov->iov_base = (char*)iov->iov_base + done;
+            iov->iov_len -= (size_t)done;
+        }
+    }
+    if (::close(fd) != 0) throw std::runtime_error("Cannot write " + path);
+}
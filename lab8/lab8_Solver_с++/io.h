@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "matrix.h"
+
+// Общий ввод-вывод для всех движков.
+// A читается из A.bin (заголовок int64 N, затем N*N double по строкам), если он есть,
+// не устарел (BinaryMatrixCurrent) и не запрещён preferText, иначе из A.txt. B.txt может содержать несколько правых
+// частей — по m чисел в строке; B получается размером n x m.
+// mem задаёт выделение A (большие страницы, first-touch): память выделяется и размечается
+// до того, как в неё попадут данные.
+void ReadSystem(const std::string& folder, Matrix& A, Matrix& B, bool preferText = false,
+                const MemoryOptions& mem = MemoryOptions());
+
+// A.bin можно читать вместо A.txt: он есть и либо A.txt нет, либо A.bin не старше A.txt,
+// его длина сходится с заголовком и N равно числу строк B.txt. Иначе A.bin остался от
+// прежней системы.
+bool BinaryMatrixCurrent(const std::string& folder);
+
+// Только B.txt для системы порядка n
+void ReadRightHandSides(const std::string& folder, int n, Matrix& B);
+
+// Числа одной строки текста [p, end) в row; p сдвигается на начало следующей строки
+void ParseLine(const char*& p, const char* end, std::vector<double>& row);
+
+// X пишется по строкам, m чисел через пробел, кратчайшей записью std::to_chars: strtod
+// читает ровно те же double. Куски строк форматируются в threads потоков, файл пишется
+// одним writev.
+void WriteSolution(const std::string& path, const Matrix& X, int threads = 1);
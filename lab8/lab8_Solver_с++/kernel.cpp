@@ -0,0 +1,166 @@
+#include "kernel.h"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LAB8_X86 1
+#endif
+
+// Без AVX2 — построчный цикл: его векторизует сам компилятор (SSE2), а ручная группа
+// строк без векторных регистров ему только мешает
+static void UpdateScalar(const double* pivot, double* const* rows, const double* factors, int count, int j0, int j1)
+{
+    for (int r = 0; r < count; ++r) {
+        double* __restrict x = rows[r];
+        const double* __restrict p = pivot;
+        double f = factors[r];
+        for (int j = j0; j < j1; ++j) x[j] -= f * p[j];
+    }
+}
+
+#ifdef LAB8_X86
+// Группы по RowGroup строк и остаток меньшей группой
+template <template <int> class G>
+static void ForGroups(const double* pivot, double* const* rows, const double* factors, int count, int j0, int j1)
+{
+    for (int r = 0; r < count; r += RowGroup) {
+        switch (std::min(RowGroup, count - r)) {
+            case 4: G<4>::Run(pivot, rows + r, factors + r, j0, j1); break;
+            case 3: G<3>::Run(pivot, rows + r, factors + r, j0, j1); break;
+            case 2: G<2>::Run(pivot, rows + r, factors + r, j0, j1); break;
+            default: G<1>::Run(pivot, rows + r, factors + r, j0, j1); break;
+        }
+    }
+}
+
+// Начало до выравнивания ведущей строки и хвост считаются тем же FMA, что и векторная
+// часть: результат элемента не зависит от того, в какую часть он попал
+#define LAB8_FMA1(f, p, x) _mm_cvtsd_f64(_mm_fnmadd_sd(_mm_set_sd(f), _mm_set_sd(p), _mm_set_sd(x)))
+
+template <int R>
+__attribute__((target("avx2,fma"))) static void GroupAvx2(const double* pivot, double* const* rows, const double* factors,
+                                                          int j0, int j1)
+{
+    __m256d f[R];
+    for (int r = 0; r < R; ++r) f[r] = _mm256_set1_pd(factors[r]);
+    int j = j0;
+    for (; j < j1 && ((uintptr_t)(pivot + j) & 31); ++j)
+        for (int r = 0; r < R; ++r) rows[r][j] = LAB8_FMA1(factors[r], pivot[j], rows[r][j]);
+    for (; j + 8 <= j1; j += 8) {
+        __m256d p0 = _mm256_load_pd(pivot + j);
+        __m256d p1 = _mm256_load_pd(pivot + j + 4);
+        for (int r = 0; r < R; ++r) {
+            double* x = rows[r] + j;
+            _mm256_storeu_pd(x, _mm256_fnmadd_pd(f[r], p0, _mm256_loadu_pd(x)));
+            _mm256_storeu_pd(x + 4, _mm256_fnmadd_pd(f[r], p1, _mm256_loadu_pd(x + 4)));
+        }
+    }
+    for (; j + 4 <= j1; j += 4) {
+        __m256d p0 = _mm256_load_pd(pivot + j);
+        for (int r = 0; r < R; ++r)
+            _mm256_storeu_pd(rows[r] + j, _mm256_fnmadd_pd(f[r], p0, _mm256_loadu_pd(rows[r] + j)));
+    }
+    for (; j < j1; ++j)
+        for (int r = 0; r < R; ++r) rows[r][j] = LAB8_FMA1(factors[r], pivot[j], rows[r][j]);
+}
+
+template <int R>
+__attribute__((target("avx512f,fma"))) static void GroupAvx512(const double* pivot, double* const* rows,
+                                                               const double* factors, int j0, int j1)
+{
+    __m512d f[R];
+    for (int r = 0; r < R; ++r) f[r] = _mm512_set1_pd(factors[r]);
+    int j = j0;
+    for (; j < j1 && ((uintptr_t)(pivot + j) & 63); ++j)
+        for (int r = 0; r < R; ++r) rows[r][j] = LAB8_FMA1(factors[r], pivot[j], rows[r][j]);
+    for (; j + 16 <= j1; j += 16) {
+        __m512d p0 = _mm512_load_pd(pivot + j);
+        __m512d p1 = _mm512_load_pd(pivot + j + 8);
+        for (int r = 0; r < R; ++r) {
+            double* x = rows[r] + j;
+            _mm512_storeu_pd(x, _mm512_fnmadd_pd(f[r], p0, _mm512_loadu_pd(x)));
+            _mm512_storeu_pd(x + 8, _mm512_fnmadd_pd(f[r], p1, _mm512_loadu_pd(x + 8)));
+        }
+    }
+    // хвост короче 16 — одной маскированной итерацией и, если нужно, ещё одной
+    while (j < j1) {
+        int left = std::min(8, j1 - j);
+        __mmask8 mask = (__mmask8)((1u << left) - 1);
+        __m512d p0 = _mm512_maskz_loadu_pd(mask, pivot + j);
+        for (int r = 0; r < R; ++r) {
+            double* x = rows[r] + j;
+            _mm512_mask_storeu_pd(x, mask, _mm512_fnmadd_pd(f[r], p0, _mm512_maskz_loadu_pd(mask, x)));
+        }
+        j += left;
+    }
+}
+
+template <int R>
+struct Avx2Group {
+    static void Run(const double* p, double* const* rows, const double* f, int j0, int j1) { GroupAvx2<R>(p, rows, f, j0, j1); }
+};
+
+template <int R>
+struct Avx512Group {
+    static void Run(const double* p, double* const* rows, const double* f, int j0, int j1) { GroupAvx512<R>(p, rows, f, j0, j1); }
+};
+
+static void UpdateAvx2(const double* pivot, double* const* rows, const double* factors, int count, int j0, int j1)
+{
+    ForGroups<Avx2Group>(pivot, rows, factors, count, j0, j1);
+}
+
+static void UpdateAvx512(const double* pivot, double* const* rows, const double* factors, int count, int j0, int j1)
+{
+    ForGroups<Avx512Group>(pivot, rows, factors, count, j0, j1);
+}
+#endif
+
+RowUpdateFn KernelFor(const std::string& name)
+{
+#ifdef LAB8_X86
+    __builtin_cpu_init();
+    bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    bool avx512 = avx2 && __builtin_cpu_supports("avx512f");
+    if (name == "avx512") return avx512 ? UpdateAvx512 : nullptr;
+    if (name == "avx2") return avx2 ? UpdateAvx2 : nullptr;
+    if (name == "auto") return avx512 ? UpdateAvx512 : avx2 ? UpdateAvx2 : UpdateScalar;
+#else
+    if (name == "avx512" || name == "avx2") return nullptr;
+    if (name == "auto") return UpdateScalar;
+#endif
+    if (name == "scalar") return UpdateScalar;
+    throw std::runtime_error("Unknown --kernel value: " + name);
+}
+
+static const char* NameOf(RowUpdateFn fn)
+{
+#ifdef LAB8_X86
+    if (fn == UpdateAvx512) return "avx512";
+    if (fn == UpdateAvx2) return "avx2";
+#endif
+    (void)fn;
+    return "scalar";
+}
+
+// Выбирается до запуска потоков движка и дальше только читается
+static RowUpdateFn& Current()
+{
+    static RowUpdateFn fn = KernelFor("auto");
+    return fn;
+}
+
+void SelectKernel(const std::string& name)
+{
+    RowUpdateFn fn = KernelFor(name);
+    if (!fn) throw std::runtime_error("CPU does not support --kernel=" + name);
+    Current() = fn;
+}
+
+const char* KernelName() { return NameOf(Current()); }
+
+void UpdateRows(const double* pivot, double* const* rows, const double* factors, int count, int j0, int j1)
+{
+    Current()(pivot, rows, factors, count, j0, j1);
+}
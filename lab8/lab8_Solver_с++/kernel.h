@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+
+// Ядро внутреннего цикла исключения: rows[r][j] -= factors[r] * pivot[j] для r < count,
+// j из [j0, j1). В avx2/avx512 строки обновляются группами по RowGroup: отрезок ведущей
+// строки загружается в регистр один раз на всю группу; scalar — построчный цикл. Набор инструкций выбирается при первом
+// вызове по CPU (avx512 > avx2 с FMA > scalar) или задаётся SelectKernel.
+// Все движки, которые считают через ядро, выполняют для каждого элемента одну и ту же
+// последовательность операций, поэтому их результаты совпадают побитно.
+const int RowGroup = 4;
+
+void UpdateRows(const double* pivot, double* const* rows, const double* factors, int count, int j0, int j1);
+
+typedef void (*RowUpdateFn)(const double* pivot, double* const* rows, const double* factors, int count, int j0, int j1);
+
+// auto | scalar | avx2 | avx512; неизвестное имя или набор, которого нет у CPU, — исключение
+void SelectKernel(const std::string& name);
+const char* KernelName();
+
+// Для замеров: ядро с данным набором инструкций или nullptr, если CPU его не поддерживает
+RowUpdateFn KernelFor(const std::string& name);
+
+// Накопитель строк одного шага: строки складываются по RowGroup и уходят в ядро
+// одним вызовом; остаток — в Flush или деструкторе
+class RowBatch {
+public:
+    RowBatch(const double* pivot, int j0, int j1) : pivot(pivot), j0(j0), j1(j1) {}
+    ~RowBatch() { Flush(); }
+    void Add(double* row, double factor)
+    {
+        rows[count] = row;
+        factors[count] = factor;
+        if (++count == RowGroup) Flush();
+    }
+    void Flush()
+    {
+        if (count) UpdateRows(pivot, rows, factors, count, j0, j1);
+        count = 0;
+    }
+
+private:
+    const double* pivot;
+    int j0, j1;
+    double* rows[RowGroup];
+    double factors[RowGroup];
+    int count = 0;
+};
@@ -0,0 +1,119 @@
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include "matrix.h"
+#include "kernel.h"
+
+// Микрозамер ядра строк (kernel.h) против исходного скалярного цикла
+// rowI[j] -= factor * rowK[j], который векторизует компилятор. Одна ведущая строка
+// вычитается из rows строк длины len; замер повторяется, пока не наберётся --ms
+// миллисекунд. GFLOP/s = 2 * rows * len * повторов / время.
+// Использование: kernel_bench [--len=256,1024,4096] [--rows=64] [--ms=200]
+
+typedef std::chrono::steady_clock Clock;
+
+static std::vector<int> ParseIntList(const std::string& s)
+{
+    std::vector<int> res;
+    std::istringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty()) res.push_back(std::stoi(item));
+    return res;
+}
+
+// Исходный цикл движков до ядра: строка за строкой, ведущая строка читается заново для каждой
+static void UpdateLoop(const double* pivot, double* const* rows, const double* factors, int count, int j0, int j1)
+{
+    for (int r = 0; r < count; ++r) {
+        double* __restrict rowI = rows[r];
+        const double* __restrict rowK = pivot;
+        double factor = factors[r];
+        for (int j = j0; j < j1; ++j) rowI[j] -= factor * rowK[j];
+    }
+}
+
+// Строки A и ведущая строка — как в Matrix: выровнены на 64 байта, с запасом в шаге.
+// Множители по очереди меняют знак, чтобы значения не уходили в бесконечность.
+static double Measure(RowUpdateFn fn, Matrix& A, int len, double budgetMs)
+{
+    const int rows = A.Rows() - 1;
+    std::vector<double*> ptrs(rows);
+    std::vector<double> plus(rows), minus(rows);
+    for (int r = 0; r < rows; ++r) {
+        ptrs[r] = A.Row(r + 1);
+        plus[r] = 1e-3 * (r + 1);
+        minus[r] = -plus[r];
+    }
+    const double* pivot = A.Row(0);
+
+    long long reps = 0;
+    auto t0 = Clock::now();
+    double ms = 0;
+    do {
+        for (int k = 0; k < 16; ++k, ++reps) fn(pivot, ptrs.data(), (reps & 1) ? minus.data() : plus.data(), rows, 0, len);
+        ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    } while (ms < budgetMs);
+    return 2.0 * rows * len * reps / (ms * 1e6);
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<int> lens = { 256, 1024, 4096 };
+    int rows = 64;
+    double budgetMs = 200;
+    try {
+        for (int a = 1; a < argc; ++a) {
+            std::string arg = argv[a];
+            if (arg.rfind("--len=", 0) == 0) lens = ParseIntList(arg.substr(6));
+            else if (arg.rfind("--rows=", 0) == 0) rows = std::max(1, std::stoi(arg.substr(7)));
+            else if (arg.rfind("--ms=", 0) == 0) budgetMs = std::stod(arg.substr(5));
+            else throw std::runtime_error("Unknown argument: " + arg);
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        std::cerr << "Использование: kernel_bench [--len=256,1024,4096] [--rows=64] [--ms=200]\n";
+        return 1;
+    }
+
+    struct Variant {
+        const char* name;
+        RowUpdateFn fn;
+    };
+    std::vector<Variant> variants = { { "loop", UpdateLoop } };
+    for (const char* isa : { "scalar", "avx2", "avx512" })
+        if (RowUpdateFn fn = KernelFor(isa)) variants.push_back({ isa, fn });
+
+    std::cout << "Ядро по умолчанию: " << KernelName() << ", строк в замере: " << rows
+              << " (группа " << RowGroup << ")\n";
+    std::cout << std::setw(8) << "len";
+    for (auto& v : variants) std::cout << std::setw(10) << v.name;
+    std::cout << "   ускорение\n";
+
+    std::mt19937_64 rng(1);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    for (int len : lens) {
+        Matrix A;
+        A.Resize(rows + 1, len);
+        for (int i = 0; i <= rows; ++i)
+            for (int j = 0; j < len; ++j) A(i, j) = dist(rng);
+
+        std::cout << std::setw(8) << len << std::fixed << std::setprecision(2);
+        double loop = 0, best = 0;
+        for (auto& v : variants) {
+            double gflops = Measure(v.fn, A, len, budgetMs);
+            if (v.fn == UpdateLoop) loop = gflops;
+            best = std::max(best, gflops);
+            std::cout << std::setw(10) << gflops;
+        }
+        std::cout << std::setw(11) << best / loop << "x\n";
+    }
+    std::cout << "GFLOP/s; loop — исходный цикл движков, scalar/avx2/avx512 — ядро kernel.h\n";
+    return 0;
+}
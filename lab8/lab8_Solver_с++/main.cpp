@@ -0,0 +1,457 @@
+#include <vector>
+#include <string>
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
+#include <sstream>
+#include <cfloat>
+#include "matrix.h"
+#include "io.h"
+#include "engine.h"
+#include "topology.h"
+#include "trace.h"
+#include "kernel.h"
+#include "condition.h"
+#include "tune.h"
+#ifdef LAB8_WITH_MPI
+#include <mpi.h>
+#endif
+
+// Общая точка входа lab8: чтение, разложение выбранным движком, общие подстановки и запись.
+// Все движки работают с одной матрицей Matrix и одинаково замеряются, так что их
+// строки TIMINGS можно сравнивать напрямую.
+// Кэш LU (--cache), смешанная точность (--mixed), ленточный, разреженный и холецкий пути
+// пока есть только в lab8_MultiThread_с++/linux_main и через движки не проходят.
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double MsSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+#ifdef LAB8_WITH_MPI
+// Трассы и сводки остальных рангов собираются на ранге 0 сразу после разложения,
+// пока все ранги ещё вместе; на ранге 0 результат дописывается в remote
+static void GatherTrace(int rank, std::string& remoteEvents, std::string& remoteSummary)
+{
+    int size;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    for (int part = 0; part < 2; ++part) {
+        std::string mine = (rank == 0) ? std::string() : (part == 0 ? Trace::ChromeEvents(rank) : Trace::Summary(rank));
+        int len = (int)mine.size();
+        std::vector<int> lens(size), offsets(size);
+        MPI_Gather(&len, 1, MPI_INT, lens.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+        int total = 0;
+        for (int p = 0; p < size; ++p) {
+            offsets[p] = total;
+            total += lens[p];
+        }
+        std::vector<char> all(rank == 0 ? std::max(total, 1) : 1);
+        MPI_Gatherv(mine.data(), len, MPI_CHAR, all.data(), lens.data(), offsets.data(), MPI_CHAR, 0, MPI_COMM_WORLD);
+        if (rank != 0) continue;
+        std::string& dst = (part == 0) ? remoteEvents : remoteSummary;
+        for (int p = 1; p < size; ++p) {
+            if (lens[p] == 0) continue;
+            if (part == 0 && !dst.empty()) dst += ",\n";
+            dst.append(all.data() + offsets[p], lens[p]);
+        }
+    }
+}
+#endif
+
+// Автонастройка: замеры на порядках sizes, лучшие параметры — в профиль. Прежние
+// замеры других порядков из того же профиля сохраняются.
+static int RunTune(const std::vector<int>& sizes, const std::string& engines, int reps, const std::string& profilePath)
+{
+    std::vector<std::string> list;
+    std::istringstream in(engines);
+    std::string item;
+    while (std::getline(in, item, ',')) list.push_back(item);
+    for (int n : sizes)
+        if (n <= 0) throw std::runtime_error("--tune sizes must be positive");
+
+    TuneProfile profile;
+    std::string why;
+    profile.Load(profilePath, why);
+    std::cout << "Автонастройка: порядков " << sizes.size() << ", ядро строк " << KernelName() << "\n";
+    auto t0 = Clock::now();
+    RunTuning(sizes, list, reps, profile, std::cout);
+    profile.Save(profilePath);
+    std::cout << "Профиль записан: " << profilePath << " (" << MsSince(t0) / 1000 << " с)\n";
+    return 0;
+}
+
+static int Run(int argc, char* argv[], int rank)
+{
+    if (argc < 2) {
+        if (rank == 0) {
+            std::cerr << "Ожидался аргумент — путь к папке с данными\n";
+            std::cerr << "Использование: solver_main <папка> [--engine=serial|threads|tiled|stream|mpi] [--threads=T]\n"
+                      << "                   [--dist=block|cyclic|dynamic] [--block=B] [--tile=NB] [--text] [--verify[=TOL]]\n"
+                      << "                   [--stream-queue=ROWS] [--kernel=auto|scalar|avx2|avx512]\n"
+                      << "                   [--cond] [--ill=warn|stop|pivot|refine] [--cond-limit=C] [--growth-limit=G]\n"
+                      << "                   [--affinity=none|physical|compact|scatter] [--first-touch] [--hugepages]\n"
+                      << "                   [--trace=trace.json] [--trace-sample=K] [--trace-events=N]\n"
+                      << "                   [--profile=PATH] [--no-profile]\n"
+                      << "       solver_main --tune=N1,N2,... [--engine=threads,tiled] [--tune-reps=R] [--profile=PATH]\n";
+        }
+        return 1;
+    }
+
+    std::string folder;
+    std::string engineName = "threads";
+    bool engineGiven = false;
+    EngineOptions opt;
+    // по умолчанию — по потоку на физическое ядро: SMT-соседи делят одни и те же FMA-блоки
+    std::vector<CpuInfo> topo = ReadTopology();
+    opt.threads = PhysicalCores(topo);
+    bool firstTouch = false;
+    bool hugePages = false;
+    bool preferText = false;
+    bool verify = false;
+    double verifyTol = 1e-10;
+    std::string kernelName = "auto";
+    // Плохая обусловленность: warn — только сообщить, stop — не писать X (код 2),
+    // pivot — переразложить с выбором ведущего элемента, refine — уточнить решение,
+    // а если не сходится или разложение сорвалось — pivot и уточнение
+    bool cond = false;
+    std::string ill = "warn";
+    double condLimit = 1e12;     // cond_1 * eps > 1e-4: верных знаков меньше четырёх
+    double growthLimit = 1e8;    // max|U| / max|A|
+    // Профиль автонастройки (tune.h): параметры, не заданные явно, берутся из него
+    std::string profilePath = DefaultProfilePath();
+    bool useProfile = true;
+    bool profileGiven = false;
+    unsigned keep = 0;
+    std::vector<int> tuneSizes;
+    int tuneReps = 3;
+    std::string tracePath;
+    int traceSample = 16;
+    long traceEvents = 1 << 16;
+    std::unique_ptr<Engine> engine;
+    try {
+        for (int a = 1; a < argc; ++a) {
+            std::string arg = argv[a];
+            if (arg.rfind("--engine=", 0) == 0) { engineName = arg.substr(9); engineGiven = true; }
+            else if (arg.rfind("--threads=", 0) == 0) { opt.threads = std::max(1, std::stoi(arg.substr(10))); keep |= KeepThreads; }
+            else if (arg.rfind("--dist=", 0) == 0) { opt.dist = arg.substr(7); keep |= KeepDist; }
+            else if (arg.rfind("--block=", 0) == 0) { opt.block = std::stoi(arg.substr(8)); keep |= KeepBlock; }
+            else if (arg.rfind("--tile=", 0) == 0) { opt.tile = std::stoi(arg.substr(7)); keep |= KeepTile; }
+            else if (arg.rfind("--profile=", 0) == 0) { profilePath = arg.substr(10); profileGiven = true; }
+            else if (arg == "--no-profile") useProfile = false;
+            else if (arg.rfind("--tune=", 0) == 0) {
+                std::istringstream list(arg.substr(7));
+                std::string item;
+                while (std::getline(list, item, ',')) tuneSizes.push_back(std::stoi(item));
+            }
+            else if (arg.rfind("--tune-reps=", 0) == 0) tuneReps = std::stoi(arg.substr(12));
+            else if (arg.rfind("--affinity=", 0) == 0) opt.affinity = arg.substr(11);
+            else if (arg.rfind("--stream-queue=", 0) == 0) opt.queueRows = std::stoi(arg.substr(15));
+            else if (arg.rfind("--kernel=", 0) == 0) kernelName = arg.substr(9);
+            else if (arg == "--cond") cond = true;
+            else if (arg.rfind("--ill=", 0) == 0) { cond = true; ill = arg.substr(6); }
+            else if (arg.rfind("--cond-limit=", 0) == 0) { cond = true; condLimit = std::stod(arg.substr(13)); }
+            else if (arg.rfind("--growth-limit=", 0) == 0) { cond = true; growthLimit = std::stod(arg.substr(15)); }
+            else if (arg == "--first-touch") firstTouch = true;
+            else if (arg == "--hugepages") hugePages = true;
+            else if (arg.rfind("--trace=", 0) == 0) tracePath = arg.substr(8);
+            else if (arg.rfind("--trace-sample=", 0) == 0) traceSample = std::stoi(arg.substr(15));
+            else if (arg.rfind("--trace-events=", 0) == 0) traceEvents = std::stol(arg.substr(15));
+            else if (arg == "--text") preferText = true;
+            else if (arg == "--verify") verify = true;
+            else if (arg.rfind("--verify=", 0) == 0) { verify = true; verifyTol = std::stod(arg.substr(9)); }
+            else folder = arg;
+        }
+        if (opt.block <= 0) throw std::runtime_error("--block must be positive");
+        if (ill != "warn" && ill != "stop" && ill != "pivot" && ill != "refine")
+            throw std::runtime_error("Unknown --ill value: " + ill);
+        if (!tuneSizes.empty()) {
+            if (rank != 0) return 0;
+            SelectKernel(kernelName);
+            return RunTune(tuneSizes, engineGiven ? engineName : "threads,tiled", tuneReps, profilePath);
+        }
+        engine = MakeEngine(engineName, opt);
+        SelectKernel(kernelName);
+        if (!tracePath.empty()) {
+            Trace::Enable((size_t)std::max(16L, traceEvents), traceSample);
+            Trace::SetThreadName(rank == 0 ? "main" : "rank " + std::to_string(rank));
+        }
+    }
+    catch (const std::exception& e) {
+        if (rank == 0) std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    // остальные ранги нужны только распределённому движку
+    if (rank != 0) {
+        if (engineName != "mpi") return 0;
+        Matrix none;
+        try {
+            engine->Factor(none);
+        }
+        catch (const std::exception&) {
+            // при pivot/refine ранг 0 сам доведёт решение запасным путём
+            return (ill == "pivot" || ill == "refine") ? 0 : 2;
+        }
+#ifdef LAB8_WITH_MPI
+        std::string unusedEvents, unusedSummary;
+        if (!tracePath.empty()) GatherTrace(rank, unusedEvents, unusedSummary);
+#endif
+        return 0;
+    }
+
+    // Профиль автонастройки — как только известен порядок; явно заданные параметры остаются.
+    // При --first-touch это происходит до разметки страниц A: размечать их должен уже
+    // настроенный движок, с теми потоками и раздачей строк, которыми он будет раскладывать
+    std::string tuned;
+    bool profileTried = false;
+    auto applyProfile = [&](int n) {
+        if (profileTried || !useProfile || !TunableEngine(engineName)) return;
+        profileTried = true;
+        TuneProfile profile;
+        std::string why;
+        if (profile.Load(profilePath, why) && profile.Apply(engineName, n, opt, keep, tuned))
+            engine = MakeEngine(engineName, opt);
+        else if (profileGiven)
+            std::cerr << "Профиль не применён: " << (why.empty() ? "нет замеров движка " + engineName : why) << "\n";
+    };
+
+    MemoryOptions mem;
+    mem.hugePages = hugePages;
+    if (firstTouch)
+        mem.firstTouch = [&](Matrix& M) {
+            applyProfile(M.Rows());
+            engine->FirstTouch(M);
+        };
+
+    Matrix A, B, A0, X;
+    double loadMs = 0, factorMs = 0, solveMs = 0;
+    std::string remoteEvents, remoteSummary;
+    // исходная A нужна проверке и запасным путям pivot/refine
+    const bool keepA = verify || ill == "pivot" || ill == "refine";
+    std::string factorError;
+
+    // Потоковый движок читает и раскладывает одновременно; разложением считается
+    // только хвост после окончания чтения, так что load_ms + factor_ms — полное время
+    auto t0 = Clock::now();
+    bool fused = false;
+    try {
+        fused = engine->ReadAndFactor(folder, A, B, preferText, mem, loadMs);
+    }
+    catch (const std::invalid_argument& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    catch (const std::exception& e) {
+        fused = true;
+        factorError = e.what();
+    }
+    if (fused) {
+        factorMs = MsSince(t0) - loadMs;
+        // исходная A читается заново: её строки уже разложены на месте (B — на случай,
+        // если разложение сорвалось раньше, чем движок дочитал B.txt)
+        if (keepA || cond) {
+            try {
+                ReadSystem(folder, A0, B, preferText);
+            }
+            catch (const std::exception& e) {
+                std::cerr << e.what() << "\n";
+                return 1;
+            }
+        }
+    }
+    else {
+        try {
+            TraceScope scope("read");
+            ReadSystem(folder, A, B, preferText, mem);
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+#ifdef LAB8_WITH_MPI
+            if (engineName == "mpi") MPI_Abort(MPI_COMM_WORLD, 1);
+#endif
+            return 1;
+        }
+        loadMs = MsSince(t0);
+        if (keepA) A0 = A;
+    }
+
+    if (!fused) applyProfile(A.Rows());
+
+    double maxA = 0, normA1 = 0;
+    if (cond) {
+        const Matrix& original = fused ? A0 : A;
+        maxA = MaxAbs(original);
+        normA1 = NormOne(original);
+        // Ранняя остановка: ведущий элемент не больше n * eps * max|A| или больше
+        // growthLimit * max|A| — дальше считать бессмысленно. Потоковый движок начинает
+        // раньше, чем известна A, и останавливается только на нулевом.
+        if (ill != "warn" && !fused) {
+            opt.pivot.tol = A.Rows() * DBL_EPSILON * maxA;
+            opt.pivot.growth = growthLimit * maxA;
+            engine = MakeEngine(engineName, opt);
+        }
+    }
+
+    if (!fused) {
+        auto t1 = Clock::now();
+        try {
+            TraceScope scope("factor");
+            engine->Factor(A);
+        }
+        catch (const std::exception& e) {
+            factorError = e.what();
+        }
+        factorMs = MsSince(t1);
+#ifdef LAB8_WITH_MPI
+        if (engineName == "mpi" && !tracePath.empty() && factorError.empty()) GatherTrace(rank, remoteEvents, remoteSummary);
+#endif
+    }
+
+    // Оценка разложения в A: обусловленность и рост элементов, O(n^2)
+    double condEst = 0, growth = 0;
+    std::string illReason = factorError;
+    auto assess = [&]() {
+        TraceScope scope("condition");
+        growth = PivotGrowth(A, maxA);
+        condEst = normA1 * EstimateInverseNormOne(A);
+        std::ostringstream why;
+        if (!(condEst <= condLimit)) why << "cond_1 ~ " << condEst << " больше " << condLimit;
+        else if (!(growth <= growthLimit)) why << "рост элементов " << growth << " больше " << growthLimit;
+        return why.str();
+    };
+    if (cond && factorError.empty()) illReason = assess();
+
+    std::vector<int> perm;   // не пуста после запасного разложения с выбором ведущего элемента
+    auto factorPivoted = [&]() {
+        auto t = Clock::now();
+        TraceScope scope("pivoted");
+        A = A0;
+        FactorPivoted(A, perm);
+        factorMs += MsSince(t);
+        if (cond) assess();
+    };
+
+    std::string action;
+    bool refine = false;
+    RefineResult refined;
+    try {
+        if (!illReason.empty()) {
+            if (!factorError.empty() && ill == "warn") {
+                std::cerr << factorError << "\n";
+                return 2;
+            }
+            if (ill == "stop") {
+                std::cerr << "Плохо обусловленная система (" << illReason << "): X не записан\n";
+                return 2;
+            }
+            if (ill == "warn") action = "решение может быть неточным";
+            else if (ill == "pivot" || !factorError.empty()) {
+                action = "переразложено с выбором ведущего элемента";
+                factorPivoted();
+            }
+            else action = "решение уточняется";
+            refine = ill == "refine";
+        }
+
+        auto t2 = Clock::now();
+        {
+            TraceScope scope("solve");
+            PermuteRows(perm, B, X);
+            SolveLU(A, X, opt.threads);
+            if (refine) {
+                refined = Refine(A0, A, perm, B, X, opt.threads);
+                // уточнение не сошлось — то же с выбором ведущего элемента
+                if (!refined.converged && perm.empty()) {
+                    action += ", уточнение не сошлось: переразложено с выбором ведущего элемента";
+                    factorPivoted();
+                    PermuteRows(perm, B, X);
+                    SolveLU(A, X, opt.threads);
+                    refined = Refine(A0, A, perm, B, X, opt.threads);
+                }
+            }
+        }
+        solveMs = MsSince(t2);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 2;
+    }
+
+    auto t3 = Clock::now();
+    try {
+        TraceScope scope("write");
+        WriteSolution(folder + "/X.txt", X, opt.threads);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    double writeMs = MsSince(t3);
+
+    const int n = A.Rows();
+    std::cout << "==============================================\n";
+    std::cout << "Размер матрицы: " << n << "x" << n << ", правых частей: " << X.Cols() << "\n";
+    std::cout << "Движок: " << engine->Name();
+    std::string details = engine->Details();
+    if (!details.empty()) std::cout << " (" << details << ")";
+    std::cout << ", ядро строк: " << KernelName() << "\n";
+    if (!tuned.empty()) std::cout << "Профиль настройки: " << profilePath << " (" << tuned << ")\n";
+    const char* pages = A.Backing() == MatrixBacking::HugeTlb ? "hugetlb 2 МБ"
+                      : A.Backing() == MatrixBacking::Transparent ? "прозрачные большие (madvise)" : "обычные";
+    std::cout << "Память A: " << A.Bytes() / (1024.0 * 1024.0) << " МБ, страницы: " << pages
+              << ", первое касание: " << (firstTouch ? "потоки движка" : "главный поток")
+              << ", NUMA-узлов: " << NumaNodes(topo) << ", физических ядер: " << PhysicalCores(topo) << "\n";
+    std::cout << "Загрузка: " << loadMs << " мс, разложение: " << factorMs << " мс, подстановки: " << solveMs
+              << " мс, запись: " << writeMs << " мс\n";
+    if (cond)
+        std::cout << "Обусловленность: cond_1 ~ " << condEst << " (оценка Хагера-Хайэма), рост элементов max|U|/max|A| = "
+                  << growth << "\n";
+    if (!illReason.empty()) std::cout << "Плохо обусловленная система (" << illReason << "): " << action << "\n";
+    if (refine)
+        std::cout << "Уточнение: итераций " << refined.iterations << ", обратная ошибка " << refined.backwardError
+                  << (refined.converged ? "" : " (не сошлось)") << "\n";
+
+    int code = 0;
+    if (verify) {
+        TraceScope scope("verify");
+        double err = BackwardError(A0, B, X);
+        std::cout << "Обратная ошибка: " << err << (err <= verifyTol ? " (в пределах " : " (ПРЕВЫШАЕТ ") << verifyTol << ")\n";
+        if (!(err <= verifyTol)) code = 3;
+    }
+    if (!tracePath.empty()) {
+        std::string events = Trace::ChromeEvents(0);
+        if (!remoteEvents.empty()) events += ",\n" + remoteEvents;
+        try {
+            Trace::WriteChrome(tracePath, events);
+            std::cout << "Трасса: " << tracePath << " (chrome://tracing, ui.perfetto.dev), выборка шагов 1/" << traceSample << "\n";
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+        }
+        std::cout << Trace::Summary(0) << remoteSummary;
+    }
+    std::cout << "==============================================\n";
+    std::cout << "TIMINGS engine=" << engine->Name() << " n=" << n << " threads=" << opt.threads
+              << " procs=" << engine->Procs() << " load_ms=" << loadMs << " factor_ms=" << factorMs
+              << " solve_ms=" << solveMs << " write_ms=" << writeMs << "\n";
+    return code;
+}
+
+int main(int argc, char* argv[])
+{
+    int rank = 0;
+#ifdef LAB8_WITH_MPI
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+    int code = Run(argc, argv, rank);
+#ifdef LAB8_WITH_MPI
+    MPI_Finalize();
+#endif
+    return code;
+}
@@ -0,0 +1,167 @@
+#pragma once
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <utility>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+class Matrix;
+
+// Как выделять память под большую матрицу.
+// hugePages — страницы по 2 МБ: сначала пул hugetlbfs (MAP_HUGETLB), иначе прозрачные
+// большие страницы через madvise; вне Linux игнорируется.
+// firstTouch — кто первым пишет в страницы. По умолчанию матрицу обнуляет вызывающий поток,
+// и при first-touch вся память оказывается на его NUMA-узле; движок может обнулить строки
+// теми же потоками, которые потом будут их обрабатывать.
+struct MemoryOptions {
+    bool hugePages = false;
+    std::function<void(Matrix&)> firstTouch;
+};
+
+enum class MatrixBacking { Heap, HugeTlb, Transparent };
+
+// Плотная матрица по строкам в одном непрерывном блоке памяти.
+// Длина строки (Stride) дополняется до кратной 64 байтам, поэтому каждая строка
+// начинается на границе кэш-линии и векторные ядра могут читать её выровненно.
+// Хвост строки за Cols() заполнен нулями и в вычислениях не участвует.
+class Matrix {
+public:
+    static const size_t ALIGN = 64;
+
+    Matrix() = default;
+    Matrix(int rows, int cols) { Resize(rows, cols); }
+
+    Matrix(const Matrix& other) { CopyFrom(other); }
+    Matrix& operator=(const Matrix& other)
+    {
+        if (this != &other) CopyFrom(other);
+        return *this;
+    }
+
+    Matrix(Matrix&& other) noexcept { Swap(other); }
+    Matrix& operator=(Matrix&& other) noexcept
+    {
+        Swap(other);
+        return *this;
+    }
+
+    ~Matrix() { Release(); }
+
+    // Прежнее содержимое не сохраняется, новая матрица заполнена нулями
+    void Resize(int rows, int cols) { Resize(rows, cols, MemoryOptions()); }
+
+    void Resize(int rows, int cols, const MemoryOptions& mem)
+    {
+        Matrix fresh;
+        fresh.rows = rows;
+        fresh.cols = cols;
+        fresh.stride = RoundStride(cols);
+        fresh.Allocate((size_t)rows * fresh.stride, mem.hugePages);
+        if (mem.firstTouch) mem.firstTouch(fresh);
+        else std::memset(fresh.data, 0, fresh.Bytes());
+        Swap(fresh);
+    }
+
+    int Rows() const { return rows; }
+    int Cols() const { return cols; }
+    size_t Stride() const { return stride; }
+    bool Empty() const { return rows == 0 || cols == 0; }
+    size_t Bytes() const { return (size_t)rows * stride * sizeof(double); }
+    MatrixBacking Backing() const { return backing; }
+
+    double* Data() { return data; }
+    const double* Data() const { return data; }
+    double* Row(int i) { return data + (size_t)i * stride; }
+    const double* Row(int i) const { return data + (size_t)i * stride; }
+    double& operator()(int i, int j) { return data[(size_t)i * stride + j]; }
+    double operator()(int i, int j) const { return data[(size_t)i * stride + j]; }
+
+    void Swap(Matrix& other) noexcept
+    {
+        std::swap(data, other.data);
+        std::swap(rows, other.rows);
+        std::swap(cols, other.cols);
+        std::swap(stride, other.stride);
+        std::swap(mapBytes, other.mapBytes);
+        std::swap(backing, other.backing);
+    }
+
+    static size_t RoundStride(int cols)
+    {
+        const size_t perLine = ALIGN / sizeof(double);
+        return ((size_t)cols + perLine - 1) / perLine * perLine;
+    }
+
+private:
+    static const size_t HUGE_PAGE = 2u << 20;
+
+    void Allocate(size_t count, bool hugePages)
+    {
+        if (count == 0) count = 1;
+        size_t bytes = count * sizeof(double);
+#ifdef __linux__
+        if (hugePages) {
+            mapBytes = (bytes + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+            void* p = mmap(nullptr, mapBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) {
+                data = (double*)p;
+                backing = MatrixBacking::HugeTlb;
+                return;
+            }
+            p = mmap(nullptr, mapBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) throw std::bad_alloc();
+            madvise(p, mapBytes, MADV_HUGEPAGE);
+            data = (double*)p;
+            backing = MatrixBacking::Transparent;
+            return;
+        }
+#else
+        (void)hugePages;
+#endif
+        void* p = nullptr;
+#ifdef _WIN32
+        p = _aligned_malloc(bytes, ALIGN);
+#else
+        if (posix_memalign(&p, ALIGN, bytes) != 0) p = nullptr;
+#endif
+        if (!p) throw std::bad_alloc();
+        data = (double*)p;
+        backing = MatrixBacking::Heap;
+    }
+
+    void Release()
+    {
+        if (!data) return;
+#ifdef __linux__
+        if (backing != MatrixBacking::Heap) {
+            munmap(data, mapBytes);
+            return;
+        }
+#endif
+#ifdef _WIN32
+        _aligned_free(data);
+#else
+        std::free(data);
+#endif
+    }
+
+    void CopyFrom(const Matrix& other)
+    {
+        Resize(other.rows, other.cols);
+        if (!other.Empty()) std::memcpy(data, other.data, Bytes());
+    }
+
+    double* data = nullptr;
+    int rows = 0;
+    int cols = 0;
+    size_t stride = 0;
+    size_t mapBytes = 0;
+    MatrixBacking backing = MatrixBacking::Heap;
+};
@@ -0,0 +1,108 @@
+#include "protocol.h"
+#include "io.h"
+#include <charconv>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+LineSocket::~LineSocket()
+{
+    if (fd >= 0) ::close(fd);
+}
+
+bool LineSocket::ReadLine(std::string& line)
+{
+    while (true) {
+        size_t nl = buf.find('\n', pos);
+        if (nl != std::string::npos) {
+            line.assign(buf, pos, nl - pos);
+            pos = nl + 1;
+            // прочитанное начало буфера выбрасывается, когда его набирается много
+            if (pos > (1 << 20)) {
+                buf.erase(0, pos);
+                pos = 0;
+            }
+            return true;
+        }
+        char chunk[1 << 16];
+        ssize_t got = ::read(fd, chunk, sizeof(chunk));
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        buf.append(chunk, (size_t)got);
+    }
+}
+
+void LineSocket::WriteAll(const std::string& data)
+{
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t w = ::send(fd, data.data() + done, data.size() - done, MSG_NOSIGNAL);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) throw std::runtime_error("Connection closed");
+        done += (size_t)w;
+    }
+}
+
+void LineSocket::ReadMatrix(Matrix& M, int rows, int cols)
+{
+    M.Resize(rows, cols);
+    std::string line;
+    std::vector<double> row;
+    for (int i = 0; i < rows; ++i) {
+        if (!ReadLine(line)) throw std::runtime_error("Connection closed");
+        const char* p = line.data();
+        ParseLine(p, p + line.size(), row);
+        if ((int)row.size() != cols) throw std::runtime_error("Expected " + std::to_string(cols) + " numbers in row " + std::to_string(i));
+        std::copy(row.begin(), row.end(), M.Row(i));
+    }
+}
+
+void AppendMatrix(std::string& out, const Matrix& M)
+{
+    char num[32];
+    for (int i = 0; i < M.Rows(); ++i)
+        for (int j = 0; j < M.Cols(); ++j) {
+            char* end = std::to_chars(num, num + sizeof(num), M(i, j)).ptr;
+            out.append(num, end);
+            out += (j + 1 < M.Cols()) ? ' ' : '\n';
+        }
+}
+
+static sockaddr_un Address(const std::string& path)
+{
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) throw std::runtime_error("Socket path is too long: " + path);
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return addr;
+}
+
+int ListenUnix(const std::string& path)
+{
+    sockaddr_un addr = Address(path);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) throw std::runtime_error("Cannot create socket");
+    ::unlink(path.c_str());
+    if (::bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(fd, 64) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot listen on " + path + ": " + std::strerror(errno));
+    }
+    return fd;
+}
+
+int ConnectUnix(const std::string& path)
+{
+    sockaddr_un addr = Address(path);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) throw std::runtime_error("Cannot create socket");
+    if (::connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot connect to " + path + ": " + std::strerror(errno));
+    }
+    return fd;
+}
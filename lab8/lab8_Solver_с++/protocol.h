@@ -0,0 +1,52 @@
+#pragma once
+#include <string>
+#include "matrix.h"
+
+// Протокол solver_daemon: текст по строкам через Unix-сокет, числа — кратчайшей записью
+// std::to_chars, так что матрицы и решения проходят через сокет без потери битов.
+//
+//   LOAD <имя> <папка> [text]     A и B из папки (как ReadSystem)  -> OK n=<n> m=<m> load_ms=<t>
+//                                 A и LU больше --memory — ERR, кэш не меняется
+//   FACTOR <имя>                  разложить, если ещё не разложена -> OK factor_ms=<t> [pivoted]
+//   SOLVE <имя> <m>               затем n строк по m чисел (B)     -> OK solve_ms=<t> factor_ms=<t>, затем n строк X
+//   SOLVEFILE <имя> <папка>       B.txt из папки, X.txt туда же    -> OK solve_ms=<t> factor_ms=<t>
+//   UPDATE <имя> <i>              затем строка из n чисел: новая строка i исходной A;
+//                                 разложение сбрасывается          -> OK
+//   DROP <имя>                                                     -> OK
+//   STATS                                                          -> OK entries=.. mb=.. hits=.. misses=.. evictions=..
+//   SHUTDOWN                                                       -> OK, демон завершается
+// Ошибка — строка ERR <текст>; соединение при этом не закрывается. Исключение — SOLVE,
+// отвергнутый до того, как B дочитана (нет матрицы, m <= 0, строка B неверна): сколько
+// строк ещё придёт, демону неизвестно, поэтому после ERR соединение закрывается.
+
+// Буферизованное чтение строк и запись целиком; fd закрывается в деструкторе
+class LineSocket {
+public:
+    explicit LineSocket(int fd) : fd(fd) {}
+    ~LineSocket();
+    LineSocket(const LineSocket&) = delete;
+    LineSocket& operator=(const LineSocket&) = delete;
+
+    int Fd() const { return fd; }
+    // в буфере уже есть целая строка: следующий ReadLine не будет ждать сокет
+    bool HasLine() const { return buf.find('\n', pos) != std::string::npos; }
+
+    // false — соединение закрыто
+    bool ReadLine(std::string& line);
+    // исключение при ошибке записи
+    void WriteAll(const std::string& data);
+
+    // rows строк по cols чисел; исключение, если соединение оборвалось или строка короче
+    void ReadMatrix(Matrix& M, int rows, int cols);
+
+private:
+    int fd;
+    std::string buf;
+    size_t pos = 0;
+};
+
+// M построчно в out, как WriteSolution
+void AppendMatrix(std::string& out, const Matrix& M);
+
+int ListenUnix(const std::string& path);
+int ConnectUnix(const std::string& path);
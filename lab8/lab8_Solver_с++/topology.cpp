@@ -0,0 +1,210 @@
+#include "topology.h"
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <set>
+#include <algorithm>
+#include <stdexcept>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// "0-3,8,10-11" -> {0,1,2,3,8,10,11}
+static std::vector<int> ParseCpuList(const std::string& s)
+{
+    std::vector<int> res;
+    std::istringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty() || item == "\n") continue;
+        size_t dash = item.find('-');
+        int a = std::stoi(item.substr(0, dash));
+        int b = (dash == std::string::npos) ? a : std::stoi(item.substr(dash + 1));
+        for (int c = a; c <= b; ++c) res.push_back(c);
+    }
+    return res;
+}
+
+static bool ReadFirstLine(const std::string& path, std::string& line)
+{
+    std::ifstream f(path);
+    return f && std::getline(f, line) && !line.empty();
+}
+
+static int ReadInt(const std::string& path, int fallback)
+{
+    std::string line;
+    if (!ReadFirstLine(path, line)) return fallback;
+    try {
+        return std::stoi(line);
+    }
+    catch (const std::exception&) {
+        return fallback;
+    }
+}
+
+std::vector<CpuInfo> ReadTopology()
+{
+    std::vector<CpuInfo> topo;
+    std::string line;
+    if (ReadFirstLine("/sys/devices/system/cpu/online", line)) {
+        for (int cpu : ParseCpuList(line)) {
+            std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+            CpuInfo c;
+            c.cpu = cpu;
+            c.package = ReadInt(base + "physical_package_id", 0);
+            c.core = ReadInt(base + "core_id", cpu);
+            c.node = 0;
+            topo.push_back(c);
+        }
+        for (int node = 0; node < 1024; ++node) {
+            if (!ReadFirstLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist", line)) {
+                if (node > 0) break;
+                continue;
+            }
+            for (int cpu : ParseCpuList(line))
+                for (CpuInfo& c : topo)
+                    if (c.cpu == cpu) c.node = node;
+        }
+    }
+    if (topo.empty()) {
+        int n = (int)std::max(1u, std::thread::hardware_concurrency());
+        for (int cpu = 0; cpu < n; ++cpu) topo.push_back({ cpu, cpu, 0, 0 });
+    }
+    return topo;
+}
+
+int PhysicalCores(const std::vector<CpuInfo>& topo)
+{
+    std::set<std::pair<int, int>> cores;
+    for (const CpuInfo& c : topo) cores.insert({ c.package, c.core });
+    return std::max(1, (int)cores.size());
+}
+
+int NumaNodes(const std::vector<CpuInfo>& topo)
+{
+    std::set<int> nodes;
+    for (const CpuInfo& c : topo) nodes.insert(c.node);
+    return std::max(1, (int)nodes.size());
+}
+
+Affinity ParseAffinity(const std::string& s)
+{
+    if (s == "none") return Affinity::None;
+    if (s == "physical") return Affinity::Physical;
+    if (s == "compact") return Affinity::Compact;
+    if (s == "scatter") return Affinity::Scatter;
+    throw std::runtime_error("Unknown --affinity value: " + s);
+}
+
+const char* AffinityName(Affinity a)
+{
+    switch (a) {
+        case Affinity::None: return "none";
+        case Affinity::Physical: return "physical";
+        case Affinity::Compact: return "compact";
+        case Affinity::Scatter: return "scatter";
+    }
+    return "?";
+}
+
+std::vector<int> PlanAffinity(Affinity mode, int threads, const std::vector<CpuInfo>& topo)
+{
+    if (mode == Affinity::None || topo.empty()) return {};
+
+    // узел, сокет, ядро, затем SMT-соседи по номеру CPU
+    std::vector<CpuInfo> sorted(topo);
+    std::sort(sorted.begin(), sorted.end(), [](const CpuInfo& a, const CpuInfo& b) {
+        if (a.node != b.node) return a.node < b.node;
+        if (a.package != b.package) return a.package < b.package;
+        if (a.core != b.core) return a.core < b.core;
+        return a.cpu < b.cpu;
+    });
+
+    // первый CPU каждого физического ядра и остальные SMT-соседи отдельно
+    std::vector<CpuInfo> primary, siblings;
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        bool first = i == 0 || sorted[i].package != sorted[i - 1].package || sorted[i].core != sorted[i - 1].core;
+        (first ? primary : siblings).push_back(sorted[i]);
+    }
+
+    std::vector<int> order;
+    switch (mode) {
+        case Affinity::Physical:
+            for (const CpuInfo& c : primary) order.push_back(c.cpu);
+            break;
+        case Affinity::Compact:
+            for (const CpuInfo& c : sorted) order.push_back(c.cpu);
+            break;
+        case Affinity::Scatter: {
+            // по кругу между узлами: сначала физические ядра, затем соседи
+            for (const std::vector<CpuInfo>* group : { &primary, &siblings }) {
+                int nodes = 0;
+                for (const CpuInfo& c : *group) nodes = std::max(nodes, c.node + 1);
+                std::vector<std::vector<int>> perNode(nodes);
+                for (const CpuInfo& c : *group) perNode[c.node].push_back(c.cpu);
+                for (size_t r = 0;; ++r) {
+                    bool any = false;
+                    for (auto& v : perNode)
+                        if (r < v.size()) {
+                            order.push_back(v[r]);
+                            any = true;
+                        }
+                    if (!any) break;
+                }
+            }
+            break;
+        }
+        case Affinity::None:
+            break;
+    }
+
+    std::vector<int> plan(threads);
+    for (int t = 0; t < threads; ++t) plan[t] = order[t % order.size()];
+    return plan;
+}
+
+#ifdef __linux__
+
+bool PinCurrentThread(int cpu)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+AffinityGuard::AffinityGuard() : saved(sizeof(cpu_set_t))
+{
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), (cpu_set_t*)saved.data()) != 0) saved.clear();
+}
+
+AffinityGuard::~AffinityGuard()
+{
+    if (!saved.empty()) pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), (const cpu_set_t*)saved.data());
+}
+
+#else
+
+bool PinCurrentThread(int) { return false; }
+AffinityGuard::AffinityGuard() {}
+AffinityGuard::~AffinityGuard() {}
+
+#endif
+
+void RunOnThreads(int threads, const std::vector<int>& cpus, const std::function<void(int)>& fn)
+{
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t)
+        pool.emplace_back([&, t] {
+            if (!cpus.empty()) PinCurrentThread(cpus[t]);
+            fn(t);
+        });
+    {
+        AffinityGuard guard;
+        if (!cpus.empty()) PinCurrentThread(cpus[0]);
+        fn(0);
+    }
+    for (auto& th : pool) th.join();
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+
+// Топология процессоров из /sys/devices/system: логический CPU, физическое ядро,
+// сокет и NUMA-узел. Вне Linux (или без sysfs) каждый CPU считается отдельным ядром узла 0.
+struct CpuInfo {
+    int cpu;
+    int core;
+    int package;
+    int node;
+};
+
+std::vector<CpuInfo> ReadTopology();
+
+// Число физических ядер (SMT-соседи считаются одним ядром)
+int PhysicalCores(const std::vector<CpuInfo>& topo);
+int NumaNodes(const std::vector<CpuInfo>& topo);
+
+// Раскладка потоков по CPU:
+//   none     — не закреплять;
+//   physical — по одному потоку на физическое ядро, узел за узлом;
+//   compact  — подряд, включая SMT-соседей: сначала заполняется первый узел;
+//   scatter  — физические ядра по кругу между узлами, SMT-соседи в последнюю очередь.
+// Потоков больше, чем CPU в раскладке, — раскладка повторяется по кругу.
+enum class Affinity { None, Physical, Compact, Scatter };
+
+Affinity ParseAffinity(const std::string& s);
+const char* AffinityName(Affinity a);
+
+// CPU для потоков 0..threads-1; пусто для Affinity::None
+std::vector<int> PlanAffinity(Affinity mode, int threads, const std::vector<CpuInfo>& topo);
+
+// Закрепить текущий поток за CPU; false, если система не дала (или не Linux)
+bool PinCurrentThread(int cpu);
+
+// Запоминает маску текущего потока и восстанавливает её при выходе из области видимости:
+// главный поток работает в пуле как поток 0, но после разложения снова свободен
+class AffinityGuard {
+public:
+    AffinityGuard();
+    ~AffinityGuard();
+    AffinityGuard(const AffinityGuard&) = delete;
+    AffinityGuard& operator=(const AffinityGuard&) = delete;
+
+private:
+    std::vector<unsigned char> saved;
+};
+
+// fn(id) на threads потоках, поток id закреплён за cpus[id] (если раскладка не пуста);
+// id 0 выполняет вызывающий поток
+void RunOnThreads(int threads, const std::vector<int>& cpus, const std::function<void(int)>& fn);
@@ -0,0 +1,198 @@
+#include "trace.h"
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+struct Event {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+    long long arg;
+};
+
+struct ThreadBuffer {
+    int tid;
+    std::string name;
+    std::vector<Event> ring;
+    size_t written = 0;   // всего записано; в кольце последние min(written, size)
+};
+
+std::atomic<bool> enabled(false);
+int sampleEvery = 1;
+size_t capacity = 0;
+const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> registry;
+thread_local ThreadBuffer* local = nullptr;
+
+ThreadBuffer* Local()
+{
+    if (!local) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.emplace_back(new ThreadBuffer());
+        local = registry.back().get();
+        local->tid = (int)registry.size() - 1;
+        local->name = "thread " + std::to_string(local->tid);
+        local->ring.resize(capacity);
+    }
+    return local;
+}
+
+// Выравнивание по числу символов, а не байт: заголовки таблицы по-русски
+std::string Pad(const std::string& s, size_t width, bool left)
+{
+    size_t chars = 0;
+    for (char c : s)
+        if (((unsigned char)c & 0xC0) != 0x80) ++chars;
+    std::string fill(chars < width ? width - chars : 0, ' ');
+    return left ? s + fill : fill + s;
+}
+
+std::string Fixed(double v)
+{
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3) << v;
+    return out.str();
+}
+
+void AppendJsonString(std::ostringstream& out, const std::string& s)
+{
+    out << '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') out << '\\';
+        out << c;
+    }
+    out << '"';
+}
+
+}
+
+namespace Trace {
+
+void Enable(size_t eventsPerThread, int every)
+{
+    capacity = std::max<size_t>(eventsPerThread, 16);
+    sampleEvery = std::max(1, every);
+    enabled = true;
+}
+
+bool Enabled() { return enabled.load(std::memory_order_relaxed); }
+
+bool Sampled(int k) { return Enabled() && k % sampleEvery == 0; }
+
+void SetThreadName(const std::string& name)
+{
+    if (!Enabled()) return;
+    ThreadBuffer* b = Local();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    b->name = name;
+}
+
+uint64_t NowNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+void Record(const char* name, uint64_t startNs, uint64_t endNs, long long arg)
+{
+    ThreadBuffer* b = Local();
+    b->ring[b->written % b->ring.size()] = { name, startNs, endNs, arg };
+    ++b->written;
+}
+
+// Вызывается после того, как рабочие потоки завершились
+template <class F>
+static void ForEachEvent(F f)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (auto& b : registry) {
+        size_t n = std::min(b->written, b->ring.size());
+        for (size_t e = b->written - n; e < b->written; ++e) f(*b, b->ring[e % b->ring.size()]);
+    }
+}
+
+std::string ChromeEvents(int pid)
+{
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    bool first = true;
+    auto sep = [&] {
+        if (!first) out << ",\n";
+        first = false;
+    };
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (auto& b : registry) {
+            sep();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << b->tid << ",\"args\":{\"name\":";
+            AppendJsonString(out, b->name);
+            out << "}}";
+        }
+    }
+    ForEachEvent([&](const ThreadBuffer& b, const Event& e) {
+        sep();
+        out << "{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << b.tid
+            << ",\"ts\":" << e.start / 1000.0 << ",\"dur\":" << (e.end - e.start) / 1000.0;
+        if (e.arg >= 0) out << ",\"args\":{\"k\":" << e.arg << "}";
+        out << "}";
+    });
+    return out.str();
+}
+
+void WriteChrome(const std::string& path, const std::string& events)
+{
+    std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+    fout << "{\"traceEvents\":[\n" << events << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    if (!fout) throw std::runtime_error("Cannot write " + path);
+}
+
+std::string Summary(int pid)
+{
+    struct Row {
+        long long count = 0;
+        double totalMs = 0;
+        double maxMs = 0;
+    };
+    std::map<std::pair<int, std::string>, Row> rows;
+    std::map<int, std::string> names;
+    std::map<int, size_t> dropped;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (auto& b : registry) {
+            names[b->tid] = b->name;
+            if (b->written > b->ring.size()) dropped[b->tid] = b->written - b->ring.size();
+        }
+    }
+    ForEachEvent([&](const ThreadBuffer& b, const Event& e) {
+        Row& r = rows[{ b.tid, e.name }];
+        double ms = (e.end - e.start) / 1e6;
+        ++r.count;
+        r.totalMs += ms;
+        r.maxMs = std::max(r.maxMs, ms);
+    });
+
+    std::ostringstream out;
+    out << "ранг " << pid << "\n";
+    out << Pad("поток", 14, true) << Pad("фаза", 14, true) << Pad("событий", 10, false) << Pad("всего, мс", 14, false)
+        << Pad("макс, мс", 14, false) << "\n";
+    for (auto& kv : rows) {
+        out << Pad(names[kv.first.first], 14, true) << Pad(kv.first.second, 14, true)
+            << Pad(std::to_string(kv.second.count), 10, false) << Pad(Fixed(kv.second.totalMs), 14, false)
+            << Pad(Fixed(kv.second.maxMs), 14, false) << "\n";
+    }
+    for (auto& kv : dropped)
+        out << "  " << names[kv.first] << ": затёрто старых событий " << kv.second << "\n";
+    return out.str();
+}
+
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Трассировка фаз решателя. У каждого потока свой кольцевой буфер событий, запись
+// события — два чтения часов и запись в свой буфер без блокировок; при переполнении
+// затираются самые старые события. Пока трассировка не включена, TraceScope только
+// проверяет флаг.
+// Шаги исключения пишутся выборочно: только шаги k, кратные sampleEvery.
+namespace Trace {
+
+void Enable(size_t eventsPerThread, int sampleEvery);
+bool Enabled();
+bool Sampled(int k);
+
+// Имя текущего потока в трассе ("main", "threads/2", ...)
+void SetThreadName(const std::string& name);
+
+uint64_t NowNs();
+void Record(const char* name, uint64_t startNs, uint64_t endNs, long long arg);
+
+// События всех потоков в формате Chrome trace (массив traceEvents без скобок);
+// pid — номер процесса (ранг MPI), чтобы трассы рангов можно было склеить в одну
+std::string ChromeEvents(int pid);
+void WriteChrome(const std::string& path, const std::string& events);
+
+// Таблица: поток, фаза, число событий, суммарное и максимальное время
+std::string Summary(int pid);
+
+}
+
+class TraceScope {
+public:
+    // record = false — событие не пишется (шаг вне выборки: TraceScope s("step", k, Trace::Sampled(k)))
+    TraceScope(const char* name, long long arg = -1, bool record = true)
+        : name(record && Trace::Enabled() ? name : nullptr), arg(arg)
+    {
+        if (this->name) start = Trace::NowNs();
+    }
+    ~TraceScope()
+    {
+        if (name) Trace::Record(name, start, Trace::NowNs(), arg);
+    }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    long long arg;
+    uint64_t start = 0;
+};
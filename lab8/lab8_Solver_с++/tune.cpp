@@ -0,0 +1,268 @@
+#include "tune.h"
+#include "topology.h"
+#include "kernel.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <unistd.h>
+#include <sys/stat.h>
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static int LogicalCpus() { return std::max(1, (int)ReadTopology().size()); }
+
+static std::string HostName()
+{
+    char buf[256];
+    if (gethostname(buf, sizeof(buf)) != 0) return "localhost";
+    buf[sizeof(buf) - 1] = 0;
+    return buf;
+}
+
+std::string DefaultProfilePath()
+{
+    const char* env = std::getenv("LAB8_TUNE_PROFILE");
+    if (env && *env) return env;
+    const char* home = std::getenv("HOME");
+    return std::string(home && *home ? home : ".") + "/.lab8/tune-" + HostName() + ".txt";
+}
+
+bool TunableEngine(const std::string& engine) { return engine == "threads" || engine == "tiled"; }
+
+bool TuneProfile::Load(const std::string& path, std::string& why)
+{
+    entries.clear();
+    std::ifstream in(path);
+    if (!in) {
+        why = "нет файла " + path;
+        return false;
+    }
+    int cpus = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        const bool header = !line.empty() && line[0] == '#';
+        std::istringstream tokens(header ? line.substr(1) : line);
+        std::string token;
+        TuneEntry e;
+        while (tokens >> token) {
+            size_t eq = token.find('=');
+            if (eq == std::string::npos) continue;
+            const std::string key = token.substr(0, eq), value = token.substr(eq + 1);
+            if (header) {
+                if (key == "cpus") cpus = std::atoi(value.c_str());
+            }
+            else if (key == "engine") e.engine = value;
+            else if (key == "n") e.n = std::atoi(value.c_str());
+            else if (key == "threads") e.threads = std::max(1, std::atoi(value.c_str()));
+            else if (key == "dist") e.dist = value;
+            else if (key == "block") e.block = std::max(1, std::atoi(value.c_str()));
+            else if (key == "tile") e.tile = std::max(1, std::atoi(value.c_str()));
+            else if (key == "ms") e.ms = std::atof(value.c_str());
+        }
+        if (!header && !e.engine.empty() && e.n > 0) Set(e);
+    }
+    if (cpus != LogicalCpus()) {
+        why = "профиль " + path + " снят на машине с " + std::to_string(cpus) + " CPU, здесь " +
+              std::to_string(LogicalCpus());
+        entries.clear();
+        return false;
+    }
+    if (entries.empty()) {
+        why = "в профиле " + path + " нет замеров";
+        return false;
+    }
+    return true;
+}
+
+void TuneProfile::Save(const std::string& path) const
+{
+    size_t slash = path.rfind('/');
+    if (slash != std::string::npos && slash > 0) mkdir(path.substr(0, slash).c_str(), 0755);
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) throw std::runtime_error("Cannot create " + path);
+    out << "# lab8 tuning profile host=" << HostName() << " cpus=" << LogicalCpus()
+        << " cores=" << PhysicalCores(ReadTopology()) << " kernel=" << KernelName() << "\n";
+    for (const TuneEntry& e : entries) {
+        out << "engine=" << e.engine << " n=" << e.n << " threads=" << e.threads;
+        if (e.engine == "threads") out << " dist=" << e.dist << " block=" << e.block;
+        if (e.engine == "tiled") out << " tile=" << e.tile;
+        out << " ms=" << e.ms << "\n";
+    }
+    if (!out) throw std::runtime_error("Cannot write " + path);
+}
+
+void TuneProfile::Set(const TuneEntry& e)
+{
+    auto less = [](const TuneEntry& a, const TuneEntry& b) { return a.engine != b.engine ? a.engine < b.engine : a.n < b.n; };
+    auto it = std::lower_bound(entries.begin(), entries.end(), e, less);
+    if (it != entries.end() && it->engine == e.engine && it->n == e.n) *it = e;
+    else entries.insert(it, e);
+}
+
+bool TuneProfile::Apply(const std::string& engine, int n, EngineOptions& opt, unsigned keep, std::string& described) const
+{
+    const TuneEntry* lo = nullptr;
+    const TuneEntry* hi = nullptr;
+    for (const TuneEntry& e : entries) {
+        if (e.engine != engine) continue;
+        if (e.n <= n) lo = &e;
+        if (e.n >= n && !hi) hi = &e;
+    }
+    if (!lo && !hi) return false;
+    if (!lo) lo = hi;
+    if (!hi) hi = lo;
+
+    double t = 0.0;
+    if (lo->n != hi->n) t = (std::log((double)n) - std::log((double)lo->n)) / (std::log((double)hi->n) - std::log((double)lo->n));
+    auto geo = [t](int a, int b) { return std::exp((1 - t) * std::log((double)a) + t * std::log((double)b)); };
+
+    if (!(keep & KeepThreads)) opt.threads = std::max(1, std::min(LogicalCpus(), (int)std::lround(geo(lo->threads, hi->threads))));
+    if (!(keep & KeepDist)) opt.dist = (t < 0.5) ? lo->dist : hi->dist;
+    if (!(keep & KeepBlock)) opt.block = std::max(1, (int)std::lround(geo(lo->block, hi->block)));
+    // плитка — кратной 8: строка плитки занимает целые кэш-линии
+    if (!(keep & KeepTile)) opt.tile = std::max(8, 8 * (int)std::lround(geo(lo->tile, hi->tile) / 8));
+
+    if (lo == hi && lo->n == n) described = "замер n=" + std::to_string(n);
+    else if (lo == hi) described = "ближайший замер n=" + std::to_string(lo->n);
+    else described = "интерполяция замеров n=" + std::to_string(lo->n) + " и n=" + std::to_string(hi->n);
+    return true;
+}
+
+// Случайная матрица с диагональным преобладанием, как у gen_main: без выбора ведущего
+// элемента раскладывается устойчиво, и все точки поиска считают одно и то же
+static void FillTestMatrix(Matrix& A, int n)
+{
+    A.Resize(n, n);
+    uint64_t state = 0x9E3779B97F4A7C15ULL * (uint64_t)n;
+    auto next = [&state]() {
+        uint64_t x = (state += 0x9E3779B97F4A7C15ULL);
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return ((x ^ (x >> 31)) >> 11) * (1.0 / 9007199254740992.0);
+    };
+    for (int i = 0; i < n; ++i) {
+        double sum = 0.0;
+        for (int j = 0; j < n; ++j) {
+            if (j == i) continue;
+            A(i, j) = next() * 10 - 5;
+            sum += std::abs(A(i, j));
+        }
+        A(i, i) = sum + 1;
+    }
+}
+
+static std::string Describe(const TuneEntry& c)
+{
+    std::string s = "threads=" + std::to_string(c.threads);
+    if (c.engine == "threads") s += " dist=" + c.dist + " block=" + std::to_string(c.block);
+    if (c.engine == "tiled") s += " tile=" + std::to_string(c.tile);
+    return s;
+}
+
+static std::vector<int> ThreadCandidates()
+{
+    const int cpus = LogicalCpus();
+    std::vector<int> v;
+    for (int t = 1; t < cpus; t *= 2) v.push_back(t);
+    v.push_back(PhysicalCores(ReadTopology()));
+    v.push_back(cpus);
+    std::sort(v.begin(), v.end());
+    v.erase(std::unique(v.begin(), v.end()), v.end());
+    return v;
+}
+
+static TuneEntry TuneOne(const std::string& engine, const Matrix& A, int reps, std::ostream& log)
+{
+    const int n = A.Rows();
+    TuneEntry best;
+    best.engine = engine;
+    best.n = n;
+    best.threads = PhysicalCores(ReadTopology());   // как у solver_main по умолчанию
+    best.ms = HUGE_VAL;
+    std::map<std::string, double> seen;
+    Matrix work;
+
+    auto measure = [&](TuneEntry c) {
+        const std::string key = Describe(c);
+        if (seen.count(key)) return;
+        EngineOptions opt;
+        opt.threads = c.threads;
+        opt.dist = c.dist;
+        opt.block = c.block;
+        opt.tile = c.tile;
+        std::unique_ptr<Engine> e = MakeEngine(engine, opt);
+        double ms = HUGE_VAL;
+        for (int r = 0; r < reps; ++r) {
+            work = A;
+            auto t0 = Clock::now();
+            e->Factor(work);
+            ms = std::min(ms, std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+            // долгие точки повторять незачем: разброс мал по сравнению с самим временем
+            if (ms > 2000) break;
+        }
+        seen[key] = ms;
+        log << "  " << engine << " n=" << n << " " << key << ": " << ms << " мс\n";
+        if (ms < best.ms) {
+            best = c;
+            best.ms = ms;
+        }
+    };
+
+    measure(best);
+    const double defaultMs = best.ms;
+    const std::vector<int> threads = ThreadCandidates();
+    for (int t : threads) {
+        TuneEntry c = best;
+        c.threads = t;
+        measure(c);
+    }
+    if (engine == "threads") {
+        for (const char* d : { "block", "cyclic", "dynamic" }) {
+            TuneEntry c = best;
+            c.dist = d;
+            measure(c);
+        }
+        // при раздаче block порция не используется
+        if (best.dist != "block")
+            for (int b : { 1, 2, 4, 8, 16, 32, 64 }) {
+                TuneEntry c = best;
+                c.block = b;
+                measure(c);
+            }
+    }
+    if (engine == "tiled") {
+        for (int nb : { 32, 48, 64, 96, 128, 192, 256 }) {
+            if (nb > n) break;
+            TuneEntry c = best;
+            c.tile = nb;
+            measure(c);
+        }
+    }
+    for (int t : threads) {
+        TuneEntry c = best;
+        c.threads = t;
+        measure(c);
+    }
+    log << "n=" << n << " " << engine << ": " << Describe(best) << " — " << best.ms << " мс (по умолчанию "
+        << defaultMs << " мс)\n";
+    return best;
+}
+
+void RunTuning(const std::vector<int>& sizes, const std::vector<std::string>& engines, int reps,
+               TuneProfile& profile, std::ostream& log)
+{
+    for (const std::string& engine : engines)
+        if (!TunableEngine(engine)) throw std::runtime_error("Engine " + engine + " has no tunable parameters");
+    Matrix A;
+    for (int n : sizes) {
+        FillTestMatrix(A, n);
+        for (const std::string& engine : engines) profile.Set(TuneOne(engine, A, std::max(1, reps), log));
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include "engine.h"
+
+// Профиль автонастройки машины: лучшие параметры движков threads и tiled, найденные
+// замерами на нескольких порядках n (solver_main --tune). Текстовый файл, строка на пару
+// (движок, n), например
+//   engine=threads n=2000 threads=8 dist=cyclic block=16 ms=812.4
+// Профиль привязан к машине: в заголовке записано число логических CPU, и на машине
+// с другим числом он не применяется.
+
+struct TuneEntry {
+    std::string engine;
+    int n = 0;
+    int threads = 1;
+    std::string dist = "cyclic";
+    int block = 8;
+    int tile = 128;
+    double ms = 0.0;
+};
+
+// Какие параметры заданы явно и профилем не трогаются
+enum TuneKeep { KeepThreads = 1, KeepDist = 2, KeepBlock = 4, KeepTile = 8 };
+
+class TuneProfile {
+public:
+    // false — файла нет или он снят на другой машине (why — почему)
+    bool Load(const std::string& path, std::string& why);
+    void Save(const std::string& path) const;
+
+    // Заменяет замер того же движка и n
+    void Set(const TuneEntry& e);
+
+    // Параметры для движка и порядка n. Для n между замеренными n0 < n < n1 числовые
+    // параметры интерполируются по log n (потоки и размер плитки — геометрически),
+    // раздача строк берётся у ближайшего по log n замера; вне замеренного диапазона —
+    // параметры крайнего замера. false — для движка замеров нет.
+    // Возвращаемое описание — для отчёта.
+    bool Apply(const std::string& engine, int n, EngineOptions& opt, unsigned keep, std::string& described) const;
+
+private:
+    std::vector<TuneEntry> entries;   // по движку, затем по n
+};
+
+// $LAB8_TUNE_PROFILE или ~/.lab8/tune-<имя машины>.txt
+std::string DefaultProfilePath();
+
+// Движки, параметры которых настраиваются
+bool TunableEngine(const std::string& engine);
+
+// Для каждого n и движка: случайная матрица с диагональным преобладанием и покоординатный
+// поиск — число потоков, затем раздача строк (threads) или плитка (tiled), затем размер
+// порции, затем снова потоки при найденных остальных. Каждая точка — лучшее из reps
+// разложений. Лучшее записывается в profile, ход поиска печатается в log.
+void RunTuning(const std::vector<int>& sizes, const std::vector<std::string>& engines, int reps,
+               TuneProfile& profile, std::ostream& log);
@@ -0,0 +1,433 @@
+#include <unistd.h>
+#include <vector>
+#include <deque>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+
+// Плиточное LU-разложение без выбора ведущего элемента.
+// Шаги разложения разбиты на задачи, связанные графом зависимостей:
+//   P(k)     — разложение диагональной плитки (k,k)
+//   U(k,j)   — треугольное решение для плитки строки k
+//   L(i,k)   — треугольное решение для плитки столбца k
+//   G(i,j,k) — обновление плитки (i,j) на шаге k
+// Задача попадает в очередь, как только выполнены все её предшественники,
+// поэтому панель k+1 считается параллельно с обновлением хвоста шага k.
+
+enum class TaskType { Panel, RowSolve, ColSolve, Update };
+
+struct Task {
+    TaskType type;
+    int i;
+    int j;
+    int k;
+};
+
+static std::vector<double> Aflat;
+static std::vector<double> B;
+static int N;
+static int NB = 128;
+static int T;
+static int numThreads;
+
+static std::unique_ptr<std::atomic<int>[]> depsPanel;
+static std::unique_ptr<std::atomic<int>[]> depsRow;
+static std::unique_ptr<std::atomic<int>[]> depsCol;
+// G(i,j,k) идут по плитке строго по k, поэтому вместо счётчика на каждую тройку — по
+// плитке: 2 * (сколько шагов уже применено) + 1, пока очередной G плитки поставлен.
+// rowDone/colDone — готовы ли U(k,j) и L(i,k). Всё вместе — O(T^2) вместо O(T^3).
+static std::unique_ptr<std::atomic<int>[]> tileStage;
+static std::unique_ptr<std::atomic<char>[]> rowDone;
+static std::unique_ptr<std::atomic<char>[]> colDone;
+
+// Очереди воркеров: high — задачи критического пути (панель и всё, что её питает),
+// low — остальное обновление хвоста. Своя очередь берётся с конца, чужая — с начала.
+struct WorkerQueue {
+    std::mutex m;
+    std::deque<Task> high;
+    std::deque<Task> low;
+};
+
+static std::vector<std::unique_ptr<WorkerQueue>> queues;
+static std::atomic<long> tasksLeft(0);
+static std::atomic<long> tasksReady(0);
+static std::atomic<long> stealCount(0);
+static std::mutex idleMutex;
+static std::condition_variable idleCv;
+static std::mutex errorMutex;
+static std::string errorText;
+
+void ReadMatrixAndVector(const std::string& folder, std::vector<double>& Af, std::vector<double>& Bv, int& n)
+{
+    std::ifstream finA(folder + "/A.txt");
+    if (!finA) throw std::runtime_error("Cannot open A.txt");
+    std::string line;
+    std::vector<std::vector<double>> tmp;
+    while (std::getline(finA, line))
+    {
+        std::istringstream ss(line);
+        std::vector<double> row;
+        double v;
+        while (ss >> v) row.push_back(v);
+        if (!row.empty()) tmp.push_back(std::move(row));
+    }
+    n = (int)tmp.size();
+    if (n == 0) throw std::runtime_error("Empty A.txt");
+    Af.assign((size_t)n * n, 0.0);
+    for (int i = 0; i < n; ++i) {
+        if ((int)tmp[i].size() != n)
+            throw std::runtime_error("A.txt: inconsistent row size");
+        for (int j = 0; j < n; ++j) Af[(size_t)i * n + j] = tmp[i][j];
+    }
+
+    std::ifstream finB(folder + "/B.txt");
+    if (!finB) throw std::runtime_error("Cannot open B.txt");
+    Bv.assign(n, 0.0);
+    for (int i = 0; i < n; ++i) {
+        if (!(finB >> Bv[i])) throw std::runtime_error("B.txt not match size");
+    }
+}
+
+void WriteVector(const std::string& path, const std::vector<double>& X)
+{
+    std::ofstream fout(path);
+    fout << std::setprecision(17);
+    for (double v : X) fout << v << "\n";
+}
+
+static inline double* Tile(int i, int j) { return &Aflat[(size_t)i * NB * N + (size_t)j * NB]; }
+static inline int TileSize(int i) { return std::min(NB, N - i * NB); }
+
+// Разложение диагональной плитки на месте: L — единичная нижняя, U — верхняя
+static void KernelPanel(int k)
+{
+    double* a = Tile(k, k);
+    int m = TileSize(k);
+    for (int p = 0; p < m; ++p) {
+        double app = a[(size_t)p * N + p];
+        if (app == 0.0) throw std::runtime_error("Нулевой ведущий элемент в строке " + std::to_string(k * NB + p));
+        for (int r = p + 1; r < m; ++r) {
+            double* rowR = a + (size_t)r * N;
+            const double* rowP = a + (size_t)p * N;
+            double l = rowR[p] / app;
+            rowR[p] = l;
+            for (int c = p + 1; c < m; ++c) rowR[c] -= l * rowP[c];
+        }
+    }
+}
+
+// U(k,j) = L(k,k)^-1 * A(k,j)
+static void KernelRowSolve(int k, int j)
+{
+    const double* l = Tile(k, k);
+    double* a = Tile(k, j);
+    int m = TileSize(k);
+    int w = TileSize(j);
+    for (int p = 0; p < m; ++p) {
+        const double* rowP = a + (size_t)p * N;
+        for (int r = p + 1; r < m; ++r) {
+            double f = l[(size_t)r * N + p];
+            if (f == 0.0) continue;
+            double* rowR = a + (size_t)r * N;
+            for (int c = 0; c < w; ++c) rowR[c] -= f * rowP[c];
+        }
+    }
+}
+
+// L(i,k) = A(i,k) * U(k,k)^-1
+static void KernelColSolve(int i, int k)
+{
+    const double* u = Tile(k, k);
+    double* a = Tile(i, k);
+    int h = TileSize(i);
+    int m = TileSize(k);
+    for (int r = 0; r < h; ++r) {
+        double* rowR = a + (size_t)r * N;
+        for (int p = 0; p < m; ++p) {
+            const double* rowU = u + (size_t)p * N;
+            double l = rowR[p] / rowU[p];
+            rowR[p] = l;
+            if (l == 0.0) continue;
+            for (int c = p + 1; c < m; ++c) rowR[c] -= l * rowU[c];
+        }
+    }
+}
+
+// A(i,j) -= L(i,k) * U(k,j)
+static void KernelUpdate(int i, int j, int k)
+{
+    const double* l = Tile(i, k);
+    const double* u = Tile(k, j);
+    double* a = Tile(i, j);
+    int h = TileSize(i);
+    int m = TileSize(k);
+    int w = TileSize(j);
+    for (int r = 0; r < h; ++r) {
+        double* __restrict rowA = a + (size_t)r * N;
+        const double* rowL = l + (size_t)r * N;
+        for (int p = 0; p < m; ++p) {
+            double f = rowL[p];
+            if (f == 0.0) continue;
+            const double* __restrict rowU = u + (size_t)p * N;
+            for (int c = 0; c < w; ++c) rowA[c] -= f * rowU[c];
+        }
+    }
+}
+
+static inline bool IsCritical(const Task& t)
+{
+    if (t.type != TaskType::Update) return true;
+    return t.i == t.k + 1 || t.j == t.k + 1;
+}
+
+static void PushTask(int self, const Task& t)
+{
+    WorkerQueue& q = *queues[self];
+    {
+        std::lock_guard<std::mutex> lock(q.m);
+        if (IsCritical(t)) q.high.push_back(t);
+        else q.low.push_back(t);
+    }
+    tasksReady.fetch_add(1);
+    idleCv.notify_one();
+}
+
+static bool PopTask(int self, Task& out)
+{
+    // своя high, чужие high, своя low, чужие low
+    for (int pass = 0; pass < 2; ++pass) {
+        bool high = (pass == 0);
+        {
+            WorkerQueue& q = *queues[self];
+            std::lock_guard<std::mutex> lock(q.m);
+            std::deque<Task>& d = high ? q.high : q.low;
+            if (!d.empty()) {
+                out = d.back();
+                d.pop_back();
+                tasksReady.fetch_sub(1);
+                return true;
+            }
+        }
+        for (int s = 1; s < numThreads; ++s) {
+            WorkerQueue& q = *queues[(self + s) % numThreads];
+            std::lock_guard<std::mutex> lock(q.m);
+            std::deque<Task>& d = high ? q.high : q.low;
+            if (!d.empty()) {
+                out = d.front();
+                d.pop_front();
+                tasksReady.fetch_sub(1);
+                stealCount.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static inline void Release(int self, std::atomic<int>& counter, const Task& t)
+{
+    if (counter.fetch_sub(1) == 1) PushTask(self, t);
+}
+
+// G(i,j,k) ставится, когда плитка обновлена шагами 0..k-1 и готовы U(k,j) и L(i,k).
+// Вызывают все три события; U и L, готовые раньше плитки, дождутся, пока плитка сама
+// дойдёт до их шага. Ставит задачу тот, кто первым выставил младший бит.
+static void TryUpdate(int self, int i, int j)
+{
+    std::atomic<int>& stage = tileStage[(size_t)i * T + j];
+    int s = stage.load();
+    while (true) {
+        if (s & 1) return;
+        int k = s >> 1;
+        if (k >= std::min(i, j)) return;
+        if (!rowDone[(size_t)k * T + j].load() || !colDone[(size_t)i * T + k].load()) return;
+        if (stage.compare_exchange_weak(s, s | 1)) break;
+    }
+    PushTask(self, { TaskType::Update, i, j, s >> 1 });
+}
+
+static void RunTask(int self, const Task& t)
+{
+    switch (t.type) {
+        case TaskType::Panel:
+            KernelPanel(t.k);
+            for (int j = t.k + 1; j < T; ++j)
+                Release(self, depsRow[(size_t)t.k * T + j], { TaskType::RowSolve, t.k, j, t.k });
+            for (int i = t.k + 1; i < T; ++i)
+                Release(self, depsCol[(size_t)i * T + t.k], { TaskType::ColSolve, i, t.k, t.k });
+            break;
+        case TaskType::RowSolve:
+            KernelRowSolve(t.k, t.j);
+            rowDone[(size_t)t.k * T + t.j] = 1;
+            for (int i = t.k + 1; i < T; ++i) TryUpdate(self, i, t.j);
+            break;
+        case TaskType::ColSolve:
+            KernelColSolve(t.i, t.k);
+            colDone[(size_t)t.i * T + t.k] = 1;
+            for (int j = t.k + 1; j < T; ++j) TryUpdate(self, t.i, j);
+            break;
+        case TaskType::Update: {
+            KernelUpdate(t.i, t.j, t.k);
+            int n = t.k + 1;
+            tileStage[(size_t)t.i * T + t.j] = 2 * n;
+            if (t.i == n && t.j == n)
+                Release(self, depsPanel[n], { TaskType::Panel, n, n, n });
+            else if (t.i == n)
+                Release(self, depsRow[(size_t)n * T + t.j], { TaskType::RowSolve, n, t.j, n });
+            else if (t.j == n)
+                Release(self, depsCol[(size_t)t.i * T + n], { TaskType::ColSolve, t.i, n, n });
+            else
+                TryUpdate(self, t.i, t.j);
+            break;
+        }
+    }
+    tasksLeft.fetch_sub(1);
+}
+
+static void WorkerRoutine(int self)
+{
+    Task t;
+    while (tasksLeft.load() > 0) {
+        if (PopTask(self, t)) {
+            try {
+                RunTask(self, t);
+            }
+            catch (const std::exception& e) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (errorText.empty()) errorText = e.what();
+                tasksLeft = 0;
+            }
+            if (tasksLeft.load() == 0) idleCv.notify_all();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(idleMutex);
+        idleCv.wait_for(lock, std::chrono::milliseconds(1),
+                        [] { return tasksReady.load() > 0 || tasksLeft.load() == 0; });
+    }
+}
+
+void TiledFactorization()
+{
+    T = (N + NB - 1) / NB;
+    size_t TT = (size_t)T * T;
+    depsPanel.reset(new std::atomic<int>[T]);
+    depsRow.reset(new std::atomic<int>[TT]);
+    depsCol.reset(new std::atomic<int>[TT]);
+    tileStage.reset(new std::atomic<int>[TT]);
+    rowDone.reset(new std::atomic<char>[TT]);
+    colDone.reset(new std::atomic<char>[TT]);
+    for (size_t t = 0; t < TT; ++t) {
+        tileStage[t] = 0;
+        rowDone[t] = 0;
+        colDone[t] = 0;
+    }
+
+    long total = 0;
+    for (int k = 0; k < T; ++k) {
+        depsPanel[k] = (k > 0) ? 1 : 0;
+        ++total;
+        for (int j = k + 1; j < T; ++j) {
+            depsRow[(size_t)k * T + j] = 1 + (k > 0);
+            depsCol[(size_t)j * T + k] = 1 + (k > 0);
+            total += 2;
+        }
+        total += (long)(T - k - 1) * (T - k - 1);
+    }
+
+    queues.clear();
+    for (int t = 0; t < numThreads; ++t) queues.emplace_back(new WorkerQueue());
+    tasksLeft = total;
+    tasksReady = 0;
+    stealCount = 0;
+    PushTask(0, { TaskType::Panel, 0, 0, 0 });
+
+    std::vector<std::thread> pool;
+    for (int t = 0; t < numThreads; ++t) pool.emplace_back(WorkerRoutine, t);
+    for (auto& th : pool) th.join();
+
+    if (!errorText.empty()) throw std::runtime_error(errorText);
+}
+
+// Прямой ход по единичной L и обратный по U
+std::vector<double> SolveLU()
+{
+    std::vector<double> X(B);
+    for (int i = 0; i < N; ++i) {
+        const double* row = &Aflat[(size_t)i * N];
+        double sum = X[i];
+        for (int j = 0; j < i; ++j) sum -= row[j] * X[j];
+        X[i] = sum;
+    }
+    for (int i = N - 1; i >= 0; --i) {
+        const double* row = &Aflat[(size_t)i * N];
+        double sum = X[i];
+        for (int j = i + 1; j < N; ++j) sum -= row[j] * X[j];
+        X[i] = sum / row[i];
+    }
+    return X;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cerr << "Ожидался аргумент — путь к папке с данными\n";
+        std::cerr << "Использование: tiled_main <папка> [--threads=T] [--tile=NB]\n";
+        return 1;
+    }
+
+    std::string folder;
+    numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    try {
+        for (int a = 1; a < argc; ++a) {
+            std::string arg = argv[a];
+            if (arg.rfind("--threads=", 0) == 0) numThreads = std::stoi(arg.substr(10));
+            else if (arg.rfind("--tile=", 0) == 0) NB = std::stoi(arg.substr(7));
+            else folder = arg;
+        }
+        if (NB <= 0) throw std::runtime_error("--tile must be positive");
+        ReadMatrixAndVector(folder, Aflat, B, N);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    if (numThreads <= 0) numThreads = 1;
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    std::vector<double> X;
+    try {
+        TiledFactorization();
+        X = SolveLU();
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 2;
+    }
+
+    auto t2 = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = t2 - t1;
+
+    WriteVector(folder + "/X.txt", X);
+
+    std::cout << "==============================================\n";
+    std::cout << "Размер матрицы: " << N << "x" << N << "\n";
+    std::cout << "Потоков: " << numThreads << "\n";
+    std::cout << "Плитка: " << NB << " (" << T << "x" << T << " плиток)\n";
+    std::cout << "Краж задач: " << stealCount.load() << "\n";
+    std::cout << "Время: " << elapsed.count() << " мс\n";
+    std::cout << "==============================================\n";
+
+    return 0;
+}
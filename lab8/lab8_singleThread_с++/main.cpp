@@ -6,18 +6,39 @@
 #include <chrono>
 #include <cmath>
 #include <stdexcept>
+#include <charconv>
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
 using namespace std;
 
 void printW(const wstring& w)
 {
+#ifdef _WIN32
     DWORD written;
     WriteConsoleW(GetStdHandle(STD_OUTPUT_HANDLE),
                   w.c_str(),
                   (DWORD)w.size(),
                   &written,
                   nullptr);
+#else
+    // в Linux консоль ждёт UTF-8
+    string s;
+    for (wchar_t wc : w) {
+        unsigned int c = (unsigned int)wc;
+        if (c < 0x80) s += (char)c;
+        else if (c < 0x800) {
+            s += (char)(0xC0 | (c >> 6));
+            s += (char)(0x80 | (c & 0x3F));
+        } else {
+            s += (char)(0xE0 | (c >> 12));
+            s += (char)(0x80 | ((c >> 6) & 0x3F));
+            s += (char)(0x80 | (c & 0x3F));
+        }
+    }
+    cout << s << flush;
+#endif
 }
 
 void ReadMatrix(const string& fileA, const string& fileB,
@@ -45,9 +66,8 @@ void ReadMatrix(const string& fileA, const string& fileB,
         fb >> B[i];
 }
 
-vector<double> GaussianElimination(vector<vector<double>>& A, vector<double>& B, int N)
+void ForwardElimination(vector<vector<double>>& A, vector<double>& B, int N)
 {
-    // Прямой ход
     for (int k = 0; k < N; k++)
     {
         double pivot = A[k][k];
@@ -66,8 +86,10 @@ vector<double> GaussianElimination(vector<vector<double>>& A, vector<double>& B,
             B[i] -= factor * B[k];
         }
     }
+}
 
-    // Обратный ход
+vector<double> BackSubstitution(const vector<vector<double>>& A, const vector<double>& B, int N)
+{
     vector<double> X(N);
     for (int i = N - 1; i >= 0; i--)
     {
@@ -82,8 +104,10 @@ vector<double> GaussianElimination(vector<vector<double>>& A, vector<double>& B,
 
 int main(int argc, char* argv[])
 {
+#ifdef _WIN32
     SetConsoleOutputCP(CP_UTF8);
     SetConsoleCP(CP_UTF8);
+#endif
     setlocale(LC_ALL, "");
 
     if (argc < 2)
@@ -108,20 +132,27 @@ int main(int argc, char* argv[])
     vector<double> B;
 
 
+    auto loadStart = chrono::high_resolution_clock::now();
     ReadMatrix(fileA, fileB, A, B);
 
     auto start = chrono::high_resolution_clock::now();
     int N = B.size();
     printW(L"Размер матрицы: " + to_wstring(N) + L"x" + to_wstring(N) + L"\n");
-    vector<double> X = GaussianElimination(A, B, N);
+    ForwardElimination(A, B, N);
+    auto factorEnd = chrono::high_resolution_clock::now();
+    vector<double> X = BackSubstitution(A, B, N);
+    auto solveEnd = chrono::high_resolution_clock::now();
 
     {
-        ofstream w(fileX);
-        w.setf(std::ios::scientific);
-        w.precision(17);
-
-        for (int i = 0; i < N; i++)
-            w << X[i] << "\n";
+        // кратчайшая запись, которую strtod читает в тот же double, и одна запись в файл
+        string out(X.size() * 25, '\0');
+        char* p = &out[0];
+        for (int i = 0; i < N; i++) {
+            p = to_chars(p, p + 24, X[i]).ptr;
+            *p++ = '\n';
+        }
+        ofstream w(fileX, ios::binary);
+        w.write(out.data(), p - out.data());
     }
 
     auto end = chrono::high_resolution_clock::now();
@@ -129,5 +160,13 @@ int main(int argc, char* argv[])
 
     printW(L"Время: " + to_wstring(ms) + L" мс\n");
 
+    // строка для lab8_Bench_с++
+    typedef chrono::duration<double, milli> msd;
+    cout << "TIMINGS engine=single n=" << N << " threads=1 procs=1"
+         << " load_ms=" << msd(start - loadStart).count()
+         << " factor_ms=" << msd(factorEnd - start).count()
+         << " solve_ms=" << msd(solveEnd - factorEnd).count()
+         << " write_ms=" << msd(end - solveEnd).count() << "\n";
+
     return 0;
 }